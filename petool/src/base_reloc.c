@@ -0,0 +1,199 @@
+#include <string.h>
+#include "base_reloc.h"
+#include "error.h"
+#include "compat.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BASE_RELOC_SSE2
+#include <emmintrin.h>
+#endif
+
+#define BASE_RELOC_OFFSET_MASK 0x0FFF
+
+// Start iteration over the relocation blocks. An image without a base
+// relocation directory yields none.
+void base_reloc_iter_init(base_reloc_iter_t *it, const pe_headers_t *pe)
+{
+    data_directory_t dir;
+    it->pe = pe;
+    it->rva = 0;
+    it->end = 0;
+    if (pe_data_dir(pe, DATA_DIR_BASE_RELOCATION_TABLE, &dir)) {
+        it->rva = dir.VirtualAddress;
+        it->end = (dir.Size <= UINT32_MAX - dir.VirtualAddress) ? dir.VirtualAddress + dir.Size : UINT32_MAX;
+    }
+}
+
+// Locate the next block. Returns false after the last one, and also with an
+// error set if the table is damaged.
+bool base_reloc_next_block(base_reloc_iter_t *it, base_reloc_block_t *block)
+{
+    // Unlike imports, the loader walks exactly the size of the directory
+    if (it->end - it->rva < BASE_RELOC_BLOCK_HEADER_SIZE || it->rva >= it->end) {
+        it->rva = it->end;
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    const uint8_t *header = rva_ptr(pe->image, &pe->sections, it->rva, BASE_RELOC_BLOCK_HEADER_SIZE);
+    uint32_t block_size;
+    if (!header) {
+        it->rva = it->end;
+        set_error("Base relocation block is out of image");
+        return false;
+    }
+    memcpy(&block->page_rva, header, 4);
+    memcpy(&block_size, header + 4, 4);
+    if (block_size < BASE_RELOC_BLOCK_HEADER_SIZE || block_size > it->end - it->rva) {
+        it->rva = it->end;
+        set_error("Invalid base relocation block size");
+        return false;
+    }
+
+    block->entry_num = (block_size - BASE_RELOC_BLOCK_HEADER_SIZE) / 2;
+    block->entries = rva_ptr(pe->image, &pe->sections, it->rva + BASE_RELOC_BLOCK_HEADER_SIZE, 2 * block->entry_num);
+    if (!block->entries) {
+        it->rva = it->end;
+        set_error("Base relocation block is out of image");
+        return false;
+    }
+
+    it->rva += block_size;
+    return true;
+}
+
+// Classify entries from first up to end one at a time. A HIGHADJ entry takes
+// the next one as its parameter, even past end. Returns the index after the
+// last entry used.
+static __inline size_t _classify_scalar(const base_reloc_block_t *block, size_t first, size_t end, base_reloc_stats_t *stats,
+    uint32_t *fixups, size_t *fixup_num)
+{
+    size_t i = first;
+    for (; i < end; i++) {
+        uint16_t entry = (uint16_t)(block->entries[2 * i] | (block->entries[2 * i + 1] << 8));
+        unsigned int type = entry >> 12;
+        stats->type_num[type]++;
+        if (type == BASE_RELOC_ABSOLUTE) {
+            continue;
+        }
+        if (fixups) {
+            fixups[*fixup_num] = block->page_rva + (entry & BASE_RELOC_OFFSET_MASK);
+        }
+        (*fixup_num)++;
+        if (type == BASE_RELOC_HIGHADJ && i + 1 < block->entry_num) {
+            i++;
+        }
+    }
+    return i;
+}
+
+#ifdef BASE_RELOC_SSE2
+// One bit per 16-bit lane of a compare result
+static __inline int _lane_mask(__m128i cmp)
+{
+    return _mm_movemask_epi8(_mm_packs_epi16(cmp, _mm_setzero_si128()));
+}
+
+static __inline size_t _lane_count(int mask)
+{
+    mask = mask - ((mask >> 1) & 0x55);
+    mask = (mask & 0x33) + ((mask >> 2) & 0x33);
+    return (size_t)((mask + (mask >> 4)) & 0x0F);
+}
+#endif
+
+// Count entries of a block by type and, if fixups is not NULL, store the RVAs
+// they patch there. fixups must have room for entry_num RVAs. Returns the
+// number of patched locations.
+size_t base_reloc_classify(const base_reloc_block_t *block, base_reloc_stats_t *stats, uint32_t *fixups)
+{
+    stats->block_num++;
+    stats->entry_num += block->entry_num;
+
+    size_t fixup_num = 0;
+    size_t i = 0;
+#ifdef BASE_RELOC_SSE2
+    // Blocks mostly hold a run of entries of one type, followed by at most
+    // one padding entry, so groups of eight are counted with one compare.
+    // Mixed groups are counted per type present, and padding is dropped from
+    // their fixups. Only a group with HIGHADJ, whose parameter entry is not
+    // a relocation, goes to the scalar loop.
+    const __m128i offset_mask = _mm_set1_epi16(BASE_RELOC_OFFSET_MASK);
+    const __m128i page = _mm_set1_epi32((int)block->page_rva);
+    const __m128i zero = _mm_setzero_si128();
+    const uint8_t *data = block->entries;
+    while (block->entry_num - i >= 8) {
+        __m128i entries = _mm_loadu_si128((const __m128i *)(data + 2 * i));
+        __m128i types = _mm_srli_epi16(entries, 12);
+        int type = _mm_cvtsi128_si32(types) & 0xF;
+        __m128i same = _mm_cmpeq_epi16(types, _mm_set1_epi16((short)type));
+        if (_mm_movemask_epi8(same) == 0xFFFF && type != BASE_RELOC_ABSOLUTE && type != BASE_RELOC_HIGHADJ) {
+            stats->type_num[type] += 8;
+            if (fixups) {
+                __m128i offsets = _mm_and_si128(entries, offset_mask);
+                _mm_storeu_si128((__m128i *)(fixups + fixup_num), _mm_add_epi32(_mm_unpacklo_epi16(offsets, zero), page));
+                _mm_storeu_si128((__m128i *)(fixups + fixup_num + 4), _mm_add_epi32(_mm_unpackhi_epi16(offsets, zero), page));
+            }
+            fixup_num += 8;
+            i += 8;
+            continue;
+        }
+        if (_lane_mask(_mm_cmpeq_epi16(types, _mm_set1_epi16(BASE_RELOC_HIGHADJ)))) {
+            i = _classify_scalar(block, i, i + 8, stats, fixups, &fixup_num);
+            continue;
+        }
+
+        // Count each type present in the group, starting with the first one
+        int lanes = _lane_mask(same);
+        stats->type_num[type] += _lane_count(lanes);
+        int pending = ~lanes & 0xFF;
+        while (pending) {
+            type = data[2 * (i + bit_index(pending)) + 1] >> 4;
+            lanes = _lane_mask(_mm_cmpeq_epi16(types, _mm_set1_epi16((short)type)));
+            stats->type_num[type] += _lane_count(lanes);
+            pending &= ~lanes;
+        }
+
+        // Store all eight RVAs, fixup_num <= i keeps them within the array,
+        // then squeeze out the padding lanes in place
+        int kept = ~_lane_mask(_mm_cmpeq_epi16(types, zero)) & 0xFF;
+        size_t kept_num = _lane_count(kept);
+        if (fixups && kept) {
+            __m128i offsets = _mm_and_si128(entries, offset_mask);
+            uint32_t *group = fixups + fixup_num;
+            _mm_storeu_si128((__m128i *)group, _mm_add_epi32(_mm_unpacklo_epi16(offsets, zero), page));
+            _mm_storeu_si128((__m128i *)(group + 4), _mm_add_epi32(_mm_unpackhi_epi16(offsets, zero), page));
+            if (kept != (1 << kept_num) - 1) {
+                for (size_t n = 0; kept; kept &= kept - 1) {
+                    group[n++] = group[bit_index(kept)];
+                }
+            }
+        }
+        fixup_num += kept_num;
+        i += 8;
+    }
+#endif
+    _classify_scalar(block, i, block->entry_num, stats, fixups, &fixup_num);
+    return fixup_num;
+}
+
+// Decode the whole base relocation table into type statistics and, if fixups
+// is not NULL, append the RVA of every patched location to it (uint32_t).
+// On a damaged table, everything before the damage is kept.
+bool read_base_relocs(const pe_headers_t *pe, base_reloc_stats_t *stats, store_t *fixups)
+{
+    memset(stats, 0, sizeof(base_reloc_stats_t));
+
+    base_reloc_iter_t it;
+    base_reloc_block_t block;
+    base_reloc_iter_init(&it, pe);
+    while (base_reloc_next_block(&it, &block)) {
+        if (fixups) {
+            uint32_t *dest = store_alloc_n(fixups, block.entry_num);
+            fixups->size -= block.entry_num - base_reloc_classify(&block, stats, dest);
+        } else {
+            base_reloc_classify(&block, stats, NULL);
+        }
+    }
+    return !has_error();
+}
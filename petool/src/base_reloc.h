@@ -0,0 +1,66 @@
+/**
+ * @file
+ *
+ * Base relocation table decoder. Blocks are iterated in place, and the
+ * entries of a block are classified eight at a time with SSE2 where it is
+ * available, producing a histogram of relocation types and optionally the
+ * dense array of RVAs the loader patches.
+ */
+
+#ifndef BASE_RELOC_H
+#define BASE_RELOC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+#include "store.h"
+
+#define BASE_RELOC_BLOCK_HEADER_SIZE 8
+#define BASE_RELOC_TYPE_NUM 16
+
+// Base relocation types, the upper 4 bits of an entry
+typedef enum {
+    BASE_RELOC_ABSOLUTE       = 0,  // padding, skipped by the loader
+    BASE_RELOC_HIGH           = 1,
+    BASE_RELOC_LOW            = 2,
+    BASE_RELOC_HIGHLOW        = 3,
+    BASE_RELOC_HIGHADJ        = 4,  // takes the next entry as parameter
+    BASE_RELOC_MIPS_JMPADDR   = 5,  // also ARM_MOV32, RISCV_HIGH20
+    BASE_RELOC_THUMB_MOV32    = 7,  // also RISCV_LOW12I
+    BASE_RELOC_RISCV_LOW12S   = 8,
+    BASE_RELOC_MIPS_JMPADDR16 = 9,
+    BASE_RELOC_DIR64          = 10,
+} base_reloc_type_t;
+
+// Base Relocation Block: entries for one 4K page
+typedef struct
+{
+    uint32_t       page_rva;
+    size_t         entry_num;
+    const uint8_t *entries;         // entry_num little-endian 16-bit entries
+} base_reloc_block_t;
+
+// Position in the base relocation table
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            rva;        // next block
+    uint32_t            end;        // end of the table
+} base_reloc_iter_t;
+
+typedef struct
+{
+    size_t block_num;
+    size_t entry_num;               // entries, including padding and HIGHADJ parameters
+    size_t type_num[BASE_RELOC_TYPE_NUM];
+} base_reloc_stats_t;
+
+void base_reloc_iter_init(base_reloc_iter_t *it, const pe_headers_t *pe);
+bool base_reloc_next_block(base_reloc_iter_t *it, base_reloc_block_t *block);
+
+size_t base_reloc_classify(const base_reloc_block_t *block, base_reloc_stats_t *stats, uint32_t *fixups);
+bool read_base_relocs(const pe_headers_t *pe, base_reloc_stats_t *stats, store_t *fixups);
+
+#endif
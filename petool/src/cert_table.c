@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include <string.h>
+#include "cert_table.h"
+#include "error.h"
+
+// Entries start at 8-byte aligned offsets from the start of the table
+#define CERT_ALIGNMENT 8
+
+// Start iteration over the certificates. The data directory of the table
+// holds a file offset, not an RVA. An image without one yields none.
+void cert_iter_init(cert_iter_t *it, const pe_headers_t *pe)
+{
+    data_directory_t dir;
+    it->image = pe->image;
+    it->offset = 0;
+    it->end = 0;
+    if (pe_data_dir(pe, DATA_DIR_CERTIFICATE_TABLE, &dir)) {
+        it->offset = dir.VirtualAddress;
+        it->end = (dir.Size <= SIZE_MAX - it->offset) ? it->offset + dir.Size : SIZE_MAX;
+    }
+}
+
+// Decode the header of the next certificate. Returns false after the last
+// one, and also with an error set if the table is damaged.
+bool cert_next_entry(cert_iter_t *it, cert_entry_t *entry)
+{
+    if (it->offset >= it->end || it->end - it->offset < CERT_HEADER_SIZE) {
+        it->offset = it->end;
+        return false;
+    }
+
+    const uint8_t *header = image_ptr(it->image, it->offset, CERT_HEADER_SIZE);
+    if (!header) {
+        it->offset = it->end;
+        set_error("Certificate table is out of file");
+        return false;
+    }
+
+    uint32_t length;
+    memcpy(&length, header, 4);
+    memcpy(&entry->revision, header + 4, 2);
+    memcpy(&entry->type, header + 6, 2);
+    if (length < CERT_HEADER_SIZE || length > it->end - it->offset) {
+        it->offset = it->end;
+        set_error("Invalid certificate length");
+        return false;
+    }
+
+    // The header is the only part read; the data is just located
+    entry->offset = it->offset + CERT_HEADER_SIZE;
+    entry->size = length - CERT_HEADER_SIZE;
+    entry->data = image_ptr(it->image, entry->offset, entry->size);
+    if (!entry->data) {
+        it->offset = it->end;
+        set_error("Certificate is out of file");
+        return false;
+    }
+
+    size_t next = it->offset + ((length + CERT_ALIGNMENT - 1) & ~(size_t)(CERT_ALIGNMENT - 1));
+    it->offset = (next > it->offset) ? next : it->end;
+    return true;
+}
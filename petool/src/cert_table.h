@@ -0,0 +1,56 @@
+/**
+ * @file
+ *
+ * Attribute certificate table decoder. The table is located by file offset,
+ * usually in the overlay after the last section. Only the 8-byte headers of
+ * the entries are read; each certificate is returned as a view of the file.
+ */
+
+#ifndef CERT_TABLE_H
+#define CERT_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define CERT_HEADER_SIZE 8
+
+// Attribute Certificate Table entry (WIN_CERTIFICATE)
+typedef struct {
+    uint32_t dwLength;                  // including this header
+    uint16_t wRevision;
+    uint16_t wCertificateType;
+    uint8_t  bCertificate[];
+} attribute_certificate_record_t;
+
+#define WIN_CERT_REVISION_1_0 0x0100
+#define WIN_CERT_REVISION_2_0 0x0200
+#define WIN_CERT_TYPE_X509 0x0001
+#define WIN_CERT_TYPE_PKCS_SIGNED_DATA 0x0002
+#define WIN_CERT_TYPE_RESERVED_1 0x0003
+#define WIN_CERT_TYPE_TS_STACK_SIGNED 0x0004
+
+// Certificate entry
+typedef struct
+{
+    uint16_t       revision;
+    uint16_t       type;            // WIN_CERT_TYPE_*, PKCS_SIGNED_DATA for Authenticode
+    size_t         offset;          // file offset of the certificate data
+    size_t         size;
+    const uint8_t *data;
+} cert_entry_t;
+
+// Position in the certificate table
+typedef struct
+{
+    const pe_image_t *image;
+    size_t            offset;       // next entry
+    size_t            end;          // end of the table
+} cert_iter_t;
+
+void cert_iter_init(cert_iter_t *it, const pe_headers_t *pe);
+bool cert_next_entry(cert_iter_t *it, cert_entry_t *entry);
+
+#endif
@@ -0,0 +1,122 @@
+#include "checksum.h"
+#include "error.h"
+#include "compat.h"
+
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHECKSUM_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef HAVE_AVX2
+#include <immintrin.h>
+
+// Whether the AVX2 kernel may run: -1 until checked on first use
+static int avx2_support = -1;
+
+// AVX2 version of the SSE2 loop below, 64 bytes per round. Adds the words of
+// whole rounds to sum and returns the number of bytes done.
+static TARGET_AVX2 size_t _sum_words_avx2(const uint8_t *data, size_t size, uint64_t *sum)
+{
+    const __m256i low_mask = _mm256_set1_epi16(0x00FF);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i low0 = zero, high0 = zero, low1 = zero, high1 = zero;
+    size_t pos = 0;
+    for (; size - pos >= 64; pos += 64) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)(data + pos));
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)(data + pos + 32));
+        low0 = _mm256_add_epi64(low0, _mm256_sad_epu8(_mm256_and_si256(v0, low_mask), zero));
+        high0 = _mm256_add_epi64(high0, _mm256_sad_epu8(_mm256_srli_epi16(v0, 8), zero));
+        low1 = _mm256_add_epi64(low1, _mm256_sad_epu8(_mm256_and_si256(v1, low_mask), zero));
+        high1 = _mm256_add_epi64(high1, _mm256_sad_epu8(_mm256_srli_epi16(v1, 8), zero));
+    }
+    __m256i low = _mm256_add_epi64(low0, low1);
+    __m256i high = _mm256_add_epi64(high0, high1);
+    __m256i total = _mm256_add_epi64(low, _mm256_slli_epi64(high, 8));
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, total);
+    *sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return pos;
+}
+#endif
+
+// Sum of the little-endian 16-bit words in size bytes, size even. The sum
+// is kept wide and folded by the caller, so no carries are lost on the way.
+// With AVX2 the SSE2 and scalar loops only finish the tail.
+static uint64_t _sum_words(const uint8_t *data, size_t size)
+{
+    uint64_t sum = 0;
+    size_t pos = 0;
+#ifdef HAVE_AVX2
+    if (avx2_support < 0) {
+        avx2_support = cpu_has_avx2();
+    }
+    if (avx2_support) {
+        pos = _sum_words_avx2(data, size, &sum);
+    }
+#endif
+#ifdef CHECKSUM_SSE2
+    // PSADBW against zero adds eight bytes into a 64-bit lane. The low and
+    // high bytes of the words are summed apart and combined at the end, two
+    // 16-byte loads per round to keep both adders busy.
+    const __m128i low_mask = _mm_set1_epi16(0x00FF);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low0 = zero, high0 = zero, low1 = zero, high1 = zero;
+    for (; size - pos >= 32; pos += 32) {
+        __m128i v0 = _mm_loadu_si128((const __m128i *)(data + pos));
+        __m128i v1 = _mm_loadu_si128((const __m128i *)(data + pos + 16));
+        low0 = _mm_add_epi64(low0, _mm_sad_epu8(_mm_and_si128(v0, low_mask), zero));
+        high0 = _mm_add_epi64(high0, _mm_sad_epu8(_mm_srli_epi16(v0, 8), zero));
+        low1 = _mm_add_epi64(low1, _mm_sad_epu8(_mm_and_si128(v1, low_mask), zero));
+        high1 = _mm_add_epi64(high1, _mm_sad_epu8(_mm_srli_epi16(v1, 8), zero));
+    }
+    __m128i low = _mm_add_epi64(low0, low1);
+    __m128i high = _mm_add_epi64(high0, high1);
+    __m128i total = _mm_add_epi64(low, _mm_slli_epi64(high, 8));
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, total);
+    sum += lanes[0] + lanes[1];
+#endif
+    for (; pos < size; pos += 2) {
+        sum += (uint32_t)data[pos] | ((uint32_t)data[pos + 1] << 8);
+    }
+    return sum;
+}
+
+// Compute the checksum of the whole image, as the loader and
+// CheckSumMappedFile do, with the 4 bytes at checksum_offset taken as zero.
+// A trailing odd byte counts as the low byte of a word.
+uint32_t image_checksum(const pe_image_t *image, size_t checksum_offset)
+{
+    size_t even_size = image->size & ~(size_t)1;
+    uint64_t sum = _sum_words(image->data, even_size);
+    if (even_size < image->size) {
+        sum += image->data[even_size];
+    }
+
+    // Take out the CheckSum field byte by byte, so that its alignment does
+    // not matter. The full sum includes every byte, so this cannot wrap.
+    for (size_t i = checksum_offset; i < checksum_offset + 4 && i < image->size; i++) {
+        sum -= (i & 1) ? (uint64_t)image->data[i] << 8 : image->data[i];
+    }
+
+    while (sum > 0xFFFF) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+    }
+    return (uint32_t)sum + (uint32_t)image->size;
+}
+
+// Read the stored CheckSum and compute the actual one. optional_size is
+// SizeOfOptionalHeader from the COFF File Header.
+bool read_pe_checksum(const pe_image_t *image, size_t optional_offset, size_t optional_size, pe_checksum_t *checksum)
+{
+    size_t checksum_offset = optional_offset + OPTIONAL_HEADER_CHECKSUM_OFFSET;
+    if (optional_size < OPTIONAL_HEADER_CHECKSUM_OFFSET + 4) {
+        set_error("Optional header has no CheckSum field");
+        return false;
+    }
+    if (!image_read_u32(image, checksum_offset, &checksum->stored)) {
+        return false;
+    }
+    checksum->computed = image_checksum(image, checksum_offset);
+    return true;
+}
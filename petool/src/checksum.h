@@ -0,0 +1,31 @@
+/**
+ * @file
+ *
+ * PE image checksum. The CheckSum field of the optional header holds the
+ * 16-bit one's complement sum of the file, taken with the field itself
+ * zeroed, plus the file size. It is computed over the mapped image in one
+ * pass, so verifying it costs a single read of the file.
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+
+// Offset of CheckSum within the optional header, same for PE32 and PE32+
+#define OPTIONAL_HEADER_CHECKSUM_OFFSET 64
+
+// Stored and computed checksum of an image
+typedef struct
+{
+    uint32_t stored;        // CheckSum field, 0 if the linker did not set it
+    uint32_t computed;
+} pe_checksum_t;
+
+uint32_t image_checksum(const pe_image_t *image, size_t checksum_offset);
+bool read_pe_checksum(const pe_image_t *image, size_t optional_offset, size_t optional_size, pe_checksum_t *checksum);
+
+#endif
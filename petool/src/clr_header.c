@@ -0,0 +1,317 @@
+#include <string.h>
+#include "clr_header.h"
+#include "error.h"
+
+#define METADATA_ROOT_SIZE   16         // up to the version string
+#define MAX_STREAM_NAME_LEN  32         // including the terminating NUL
+#define TABLES_HEADER_SIZE   24         // up to the row counts
+
+// Flags in HeapSizes of the tables stream
+#define HEAP_STRINGS_WIDE 0x01
+#define HEAP_GUID_WIDE    0x02
+#define HEAP_BLOB_WIDE    0x04
+#define HEAP_EXTRA_DATA   0x40          // 4 bytes follow the row counts
+
+// Tables referenced by the coded indexes of the decoded tables
+#define CLR_TABLE_MODULE_REF   0x1A
+#define CLR_TABLE_TYPE_SPEC    0x1B
+#define CLR_TABLE_ASSEMBLY_REF 0x23
+
+static uint16_t _load_u16(const uint8_t *p)
+{
+    uint16_t value;
+    memcpy(&value, p, 2);
+    return value;
+}
+
+static uint32_t _load_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+// Load an index that is 2 or 4 bytes wide, depending on the sizes of heaps
+// and tables
+static uint32_t _load_index(const uint8_t **p, size_t size)
+{
+    uint32_t value = (size == 2) ? _load_u16(*p) : _load_u32(*p);
+    *p += size;
+    return value;
+}
+
+static uint32_t _align4(uint32_t value)
+{
+    return (value + 3) & ~3u;
+}
+
+// Decode the CLI header. Fails without an error set if the image is not a
+// managed one.
+bool read_clr_header(const pe_headers_t *pe, clr_header_t *header)
+{
+    data_directory_t dir;
+    if (!pe_data_dir(pe, DATA_DIR_CLR_RUNTIME_HEADER, &dir)) {
+        return false;
+    }
+
+    const void *data = rva_ptr(pe->image, &pe->sections, dir.VirtualAddress, CLR_HEADER_SIZE);
+    if (!data) {
+        set_error("CLR runtime header is out of image");
+        return false;
+    }
+    memcpy(header, data, CLR_HEADER_SIZE);
+    if (header->cb < CLR_HEADER_SIZE) {
+        set_error("Invalid CLR runtime header size");
+        return false;
+    }
+    return true;
+}
+
+// Decode the metadata root and locate the streams. No stream contents are
+// read. Fails without an error set if the image is not a managed one.
+bool read_clr_metadata(const pe_headers_t *pe, clr_metadata_t *md)
+{
+    memset(md, 0, sizeof(clr_metadata_t));
+    if (!read_clr_header(pe, &md->header)) {
+        return false;
+    }
+
+    uint32_t size = md->header.MetaData.Size;
+    const uint8_t *root = rva_ptr(pe->image, &pe->sections, md->header.MetaData.VirtualAddress, size);
+    if (!root || size < METADATA_ROOT_SIZE + 4) {
+        set_error("Metadata root is out of image");
+        return false;
+    }
+    if (_load_u32(root) != CLR_METADATA_SIGNATURE) {
+        set_error("Invalid metadata signature");
+        return false;
+    }
+    md->root = root;
+    md->size = size;
+    md->major_version = _load_u16(root + 4);
+    md->minor_version = _load_u16(root + 6);
+
+    // Version string, NUL-padded to a multiple of 4 bytes, then Flags and
+    // the number of streams
+    uint32_t version_len = _load_u32(root + 12);
+    if (version_len > size - METADATA_ROOT_SIZE - 4) {
+        set_error("Metadata version string is out of metadata");
+        return false;
+    }
+    const char *version = (const char *)root + METADATA_ROOT_SIZE;
+    const char *version_end = memchr(version, '\0', version_len);
+    md->version.str = version;
+    md->version.len = version_end ? (size_t)(version_end - version) : version_len;
+
+    uint32_t pos = METADATA_ROOT_SIZE + _align4(version_len);
+    if (pos > size - 4) {
+        set_error("Metadata stream headers are out of metadata");
+        return false;
+    }
+    md->stream_num = _load_u16(root + pos + 2);
+    pos += 4;
+
+    for (uint16_t i = 0; i < md->stream_num; i++) {
+        if (pos > size || size - pos < 8 + 4) {
+            set_error("Metadata stream headers are out of metadata");
+            return false;
+        }
+
+        clr_stream_t stream;
+        stream.offset = _load_u32(root + pos);
+        stream.size = _load_u32(root + pos + 4);
+        stream.name.str = (const char *)root + pos + 8;
+        size_t name_max = (size - pos - 8 < MAX_STREAM_NAME_LEN) ? size - pos - 8 : MAX_STREAM_NAME_LEN;
+        const char *name_end = memchr(stream.name.str, '\0', name_max);
+        if (!name_end) {
+            set_error("Invalid metadata stream name");
+            return false;
+        }
+        stream.name.len = (size_t)(name_end - stream.name.str);
+        pos += 8 + _align4((uint32_t)stream.name.len + 1);
+
+        if (stream.offset > size || stream.size > size - stream.offset) {
+            set_error("Metadata stream is out of metadata");
+            return false;
+        }
+        stream.data = root + stream.offset;
+
+        // The runtime takes the first stream of each name
+        clr_stream_t *known = NULL;
+        if (strncmp(stream.name.str, "#~", stream.name.len + 1) == 0 ||
+                strncmp(stream.name.str, "#-", stream.name.len + 1) == 0) {
+            known = &md->tables;
+        } else if (strncmp(stream.name.str, "#Strings", stream.name.len + 1) == 0) {
+            known = &md->strings;
+        } else if (strncmp(stream.name.str, "#US", stream.name.len + 1) == 0) {
+            known = &md->user_strings;
+        } else if (strncmp(stream.name.str, "#GUID", stream.name.len + 1) == 0) {
+            known = &md->guid;
+        } else if (strncmp(stream.name.str, "#Blob", stream.name.len + 1) == 0) {
+            known = &md->blob;
+        }
+        if (known && !known->data) {
+            *known = stream;
+        }
+    }
+    return true;
+}
+
+// Get a string of the #Strings heap as a view, with a NULL str if the index
+// is out of the heap
+image_str_t clr_string(const clr_metadata_t *md, uint32_t index)
+{
+    image_str_t str = { NULL, 0 };
+    if (index >= md->strings.size) {
+        return str;
+    }
+    const char *start = (const char *)md->strings.data + index;
+    const char *end = memchr(start, '\0', md->strings.size - index);
+    if (end) {
+        str.str = start;
+        str.len = (size_t)(end - start);
+    }
+    return str;
+}
+
+// Width of an index into a table
+static size_t _table_index_size(const clr_tables_t *tables, uint8_t table)
+{
+    return (tables->row_num[table] < 0x10000) ? 2 : 4;
+}
+
+// Width of a coded index: the low tag_bits select one of the tables
+static size_t _coded_index_size(const clr_tables_t *tables, const uint8_t *table_list, size_t table_num, unsigned tag_bits)
+{
+    uint32_t max_rows = 0;
+    for (size_t i = 0; i < table_num; i++) {
+        if (tables->row_num[table_list[i]] > max_rows) {
+            max_rows = tables->row_num[table_list[i]];
+        }
+    }
+    return (max_rows < (1u << (16 - tag_bits))) ? 2 : 4;
+}
+
+// Decode the header of the tables stream and locate the TypeDef and
+// MethodDef tables. Rows are not read. Fails without an error set if the
+// metadata has no tables stream.
+bool read_clr_tables(const clr_metadata_t *md, clr_tables_t *tables)
+{
+    static const uint8_t resolution_scope[] = { CLR_TABLE_MODULE, CLR_TABLE_MODULE_REF, CLR_TABLE_ASSEMBLY_REF, CLR_TABLE_TYPE_REF };
+    static const uint8_t type_def_or_ref[] = { CLR_TABLE_TYPE_DEF, CLR_TABLE_TYPE_REF, CLR_TABLE_TYPE_SPEC };
+
+    memset(tables, 0, sizeof(clr_tables_t));
+    tables->md = md;
+
+    const clr_stream_t *stream = &md->tables;
+    if (!stream->data) {
+        return false;
+    }
+    if (stream->size < TABLES_HEADER_SIZE) {
+        set_error("Metadata tables header is out of stream");
+        return false;
+    }
+    tables->heap_sizes = stream->data[6];
+    memcpy(&tables->valid, stream->data + 8, 8);
+
+    size_t pos = TABLES_HEADER_SIZE;
+    for (unsigned i = 0; i < CLR_TABLE_NUM; i++) {
+        if (tables->valid & ((uint64_t)1 << i)) {
+            if (stream->size - pos < 4) {
+                set_error("Metadata row counts are out of stream");
+                return false;
+            }
+            tables->row_num[i] = _load_u32(stream->data + pos);
+            pos += 4;
+        }
+    }
+    if (tables->heap_sizes & HEAP_EXTRA_DATA) {
+        pos += 4;
+    }
+
+    size_t string_size = (tables->heap_sizes & HEAP_STRINGS_WIDE) ? 4 : 2;
+    size_t guid_size = (tables->heap_sizes & HEAP_GUID_WIDE) ? 4 : 2;
+    size_t blob_size = (tables->heap_sizes & HEAP_BLOB_WIDE) ? 4 : 2;
+    tables->string_index_size = string_size;
+    tables->blob_index_size = blob_size;
+    tables->field_index_size = _table_index_size(tables, CLR_TABLE_FIELD);
+    tables->method_index_size = _table_index_size(tables, CLR_TABLE_METHOD_DEF);
+    tables->param_index_size = _table_index_size(tables, CLR_TABLE_PARAM);
+    tables->type_def_or_ref_size = _coded_index_size(tables, type_def_or_ref, 3, 2);
+
+    // Tables are stored in order, so only the ones up to MethodDef need
+    // their row sizes to be known
+    size_t row_size[CLR_TABLE_METHOD_DEF + 1];
+    row_size[CLR_TABLE_MODULE] = 2 + string_size + 3 * guid_size;
+    row_size[CLR_TABLE_TYPE_REF] = _coded_index_size(tables, resolution_scope, 4, 2) + 2 * string_size;
+    row_size[CLR_TABLE_TYPE_DEF] = 4 + 2 * string_size + tables->type_def_or_ref_size +
+        tables->field_index_size + tables->method_index_size;
+    row_size[CLR_TABLE_FIELD_PTR] = tables->field_index_size;
+    row_size[CLR_TABLE_FIELD] = 2 + string_size + blob_size;
+    row_size[CLR_TABLE_METHOD_PTR] = tables->method_index_size;
+    row_size[CLR_TABLE_METHOD_DEF] = 4 + 2 + 2 + string_size + blob_size + tables->param_index_size;
+
+    uint64_t offset = pos;
+    for (unsigned i = 0; i <= CLR_TABLE_METHOD_DEF; i++) {
+        uint64_t end = offset + (uint64_t)tables->row_num[i] * row_size[i];
+        if (end > stream->size) {
+            set_error("Metadata table is out of stream");
+            return false;
+        }
+        if (i == CLR_TABLE_TYPE_DEF) {
+            tables->type_defs = stream->data + offset;
+            tables->type_def_size = row_size[i];
+        } else if (i == CLR_TABLE_METHOD_DEF) {
+            tables->method_defs = stream->data + offset;
+            tables->method_def_size = row_size[i];
+        }
+        offset = end;
+    }
+    return true;
+}
+
+// Decode a row of the TypeDef table, idx being the row number minus one
+bool clr_type_def_at(const clr_tables_t *tables, uint32_t idx, clr_type_def_t *row)
+{
+    if (idx >= tables->row_num[CLR_TABLE_TYPE_DEF]) {
+        set_error("Row index is out of TypeDef table");
+        return false;
+    }
+
+    const uint8_t *p = tables->type_defs + (size_t)idx * tables->type_def_size;
+    row->flags = _load_u32(p);
+    p += 4;
+    row->name = clr_string(tables->md, _load_index(&p, tables->string_index_size));
+    row->name_space = clr_string(tables->md, _load_index(&p, tables->string_index_size));
+    row->extends = _load_index(&p, tables->type_def_or_ref_size);
+    row->field_list = _load_index(&p, tables->field_index_size);
+    row->method_list = _load_index(&p, tables->method_index_size);
+    if (!row->name.str || !row->name_space.str) {
+        set_error("Type name is out of #Strings heap");
+        return false;
+    }
+    return true;
+}
+
+// Decode a row of the MethodDef table, idx being the row number minus one
+bool clr_method_def_at(const clr_tables_t *tables, uint32_t idx, clr_method_def_t *row)
+{
+    if (idx >= tables->row_num[CLR_TABLE_METHOD_DEF]) {
+        set_error("Row index is out of MethodDef table");
+        return false;
+    }
+
+    const uint8_t *p = tables->method_defs + (size_t)idx * tables->method_def_size;
+    row->rva = _load_u32(p);
+    row->impl_flags = _load_u16(p + 4);
+    row->flags = _load_u16(p + 6);
+    p += 8;
+    row->name = clr_string(tables->md, _load_index(&p, tables->string_index_size));
+    row->signature = _load_index(&p, tables->blob_index_size);
+    row->param_list = _load_index(&p, tables->param_index_size);
+    if (!row->name.str) {
+        set_error("Method name is out of #Strings heap");
+        return false;
+    }
+    return true;
+}
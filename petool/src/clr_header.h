@@ -0,0 +1,134 @@
+/**
+ * @file
+ *
+ * CLR runtime header and .NET metadata decoder. Reading the metadata root
+ * only locates its streams, which are returned as views of the image, so
+ * triage of managed images never touches table rows. The TypeDef and
+ * MethodDef tables are located on request and decoded a row at a time.
+ */
+
+#ifndef CLR_HEADER_H
+#define CLR_HEADER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define CLR_HEADER_SIZE 72
+
+#define CLR_METADATA_SIGNATURE 0x424A5342  // "BSJB"
+
+// CLR runtime header flags
+#define COMIMAGE_FLAGS_ILONLY             0x00000001
+#define COMIMAGE_FLAGS_32BITREQUIRED      0x00000002
+#define COMIMAGE_FLAGS_IL_LIBRARY         0x00000004
+#define COMIMAGE_FLAGS_STRONGNAMESIGNED   0x00000008
+#define COMIMAGE_FLAGS_NATIVE_ENTRYPOINT  0x00000010
+#define COMIMAGE_FLAGS_TRACKDEBUGDATA     0x00010000
+#define COMIMAGE_FLAGS_32BITPREFERRED     0x00020000
+
+// Metadata tables decoded by the row reader
+#define CLR_TABLE_MODULE     0x00
+#define CLR_TABLE_TYPE_REF   0x01
+#define CLR_TABLE_TYPE_DEF   0x02
+#define CLR_TABLE_FIELD_PTR  0x03
+#define CLR_TABLE_FIELD      0x04
+#define CLR_TABLE_METHOD_PTR 0x05
+#define CLR_TABLE_METHOD_DEF 0x06
+#define CLR_TABLE_PARAM      0x08
+#define CLR_TABLE_NUM        64
+
+// CLI header (IMAGE_COR20_HEADER)
+typedef struct {
+    uint32_t         cb;                    // size of the header
+    uint16_t         MajorRuntimeVersion;
+    uint16_t         MinorRuntimeVersion;
+    data_directory_t MetaData;
+    uint32_t         Flags;                 // COMIMAGE_FLAGS_*
+    uint32_t         EntryPointToken;       // or RVA if NATIVE_ENTRYPOINT
+    data_directory_t Resources;
+    data_directory_t StrongNameSignature;
+    data_directory_t CodeManagerTable;
+    data_directory_t VTableFixups;
+    data_directory_t ExportAddressTableJumps;
+    data_directory_t ManagedNativeHeader;
+} clr_header_t;
+
+// Metadata stream, size 0 if absent
+typedef struct
+{
+    image_str_t    name;
+    uint32_t       offset;          // from the metadata root
+    uint32_t       size;
+    const uint8_t *data;
+} clr_stream_t;
+
+// Metadata root and its well-known streams
+typedef struct
+{
+    clr_header_t   header;
+    const uint8_t *root;
+    uint32_t       size;
+    uint16_t       major_version;
+    uint16_t       minor_version;
+    image_str_t    version;         // runtime version, e.g. "v4.0.30319"
+    uint16_t       stream_num;
+    clr_stream_t   tables;          // #~, or #- if unoptimized
+    clr_stream_t   strings;         // #Strings
+    clr_stream_t   user_strings;    // #US
+    clr_stream_t   guid;            // #GUID
+    clr_stream_t   blob;            // #Blob
+} clr_metadata_t;
+
+// Located metadata tables
+typedef struct
+{
+    const clr_metadata_t *md;
+    uint8_t               heap_sizes;
+    uint64_t              valid;                    // bit mask of present tables
+    uint32_t              row_num[CLR_TABLE_NUM];
+    const uint8_t        *type_defs;
+    size_t                type_def_size;            // bytes per row
+    const uint8_t        *method_defs;
+    size_t                method_def_size;
+    size_t                string_index_size;
+    size_t                blob_index_size;
+    size_t                field_index_size;
+    size_t                method_index_size;
+    size_t                param_index_size;
+    size_t                type_def_or_ref_size;
+} clr_tables_t;
+
+// TypeDef table row
+typedef struct
+{
+    uint32_t    flags;
+    image_str_t name;
+    image_str_t name_space;
+    uint32_t    extends;        // TypeDefOrRef coded index
+    uint32_t    field_list;     // first row of the Field table
+    uint32_t    method_list;    // first row of the MethodDef table
+} clr_type_def_t;
+
+// MethodDef table row
+typedef struct
+{
+    uint32_t    rva;            // of the method body, 0 if abstract or runtime-provided
+    uint16_t    impl_flags;
+    uint16_t    flags;
+    image_str_t name;
+    uint32_t    signature;      // #Blob index
+    uint32_t    param_list;     // first row of the Param table
+} clr_method_def_t;
+
+bool read_clr_header(const pe_headers_t *pe, clr_header_t *header);
+bool read_clr_metadata(const pe_headers_t *pe, clr_metadata_t *md);
+image_str_t clr_string(const clr_metadata_t *md, uint32_t index);
+
+bool read_clr_tables(const clr_metadata_t *md, clr_tables_t *tables);
+bool clr_type_def_at(const clr_tables_t *tables, uint32_t idx, clr_type_def_t *row);
+bool clr_method_def_at(const clr_tables_t *tables, uint32_t idx, clr_method_def_t *row);
+
+#endif
@@ -0,0 +1,376 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "codegen.h"
+#include "vis_struct.h"
+#include "error.h"
+
+#define MAX_IDENT_LEN (2 * MAX_NAME_LEN + 20)
+
+// C identifier of a structure name: lower case, "Name(PE32+)" becomes "name_pe32_plus"
+static void _struct_ident(const char *name, char *ident)
+{
+    size_t len = 0;
+    for (const char *p = name; *p && len < MAX_IDENT_LEN - 5; p++) {
+        if (*p == '(') {
+            ident[len++] = '_';
+        } else if (*p == '+') {
+            memcpy(ident + len, "_plus", 5);
+            len += 5;
+        } else if (isalnum((unsigned char)*p) || *p == '_') {
+            ident[len++] = (char)tolower((unsigned char)*p);
+        }
+    }
+    ident[len] = '\0';
+}
+
+// C identifier of a field name: "SizeOfOptionalHeader" becomes "size_of_optional_header"
+static void _field_ident(const char *name, char *ident)
+{
+    size_t len = 0;
+    for (const char *p = name; *p && len < MAX_IDENT_LEN - 2; p++) {
+        if (isupper((unsigned char)*p) && p != name && (islower((unsigned char)p[-1]) || isdigit((unsigned char)p[-1]))) {
+            ident[len++] = '_';
+        }
+        ident[len++] = (char)tolower((unsigned char)*p);
+    }
+    ident[len] = '\0';
+}
+
+// Fields of these sizes are loaded as integers, others and CHAR fields are kept as bytes
+static const char * _int_type(size_t size)
+{
+    switch (size)
+    {
+        case 1: return "uint8_t";
+        case 2: return "uint16_t";
+        case 4: return "uint32_t";
+        case 8: return "uint64_t";
+    }
+    return NULL;
+}
+
+// Escape characters of a string for the inside of a C string literal
+static void _put_chars(FILE *out, const char *str)
+{
+    for (const char *p = str; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', out);
+        }
+        fputc(*p, out);
+    }
+}
+
+// Escape a string for a C string literal
+static void _put_string(FILE *out, const char *str)
+{
+    fputc('"', out);
+    _put_chars(out, str);
+    fputc('"', out);
+}
+
+static void _write_header(FILE *out, const char *guard)
+{
+    fprintf(out, "/**\n * @file\n *\n * Decoders generated from petc schemas by \"petool schema codegen\". Do not edit.\n */\n\n");
+    fprintf(out, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(out, "#include <stdint.h>\n#include <stdbool.h>\n#include <stddef.h>\n#include \"image.h\"\n#include \"vis_struct.h\"\n\n");
+
+    char ident[MAX_IDENT_LEN + 1];
+    char fident[MAX_IDENT_LEN + 1];
+    for (size_t i = 0; i < vis_struct_num(); i++) {
+        const vis_struct_t *st = vis_get_struct(i);
+        _struct_ident(vis_str(st->name), ident);
+
+        fprintf(out, "// %s\n", vis_str(st->name));
+        fprintf(out, "typedef struct schema_%s_t\n{\n", ident);
+        for (size_t j = 0; j < st->fields.size; j++) {
+            const vis_field_t *field = store_pget(&st->fields, j);
+            const char *type = (field->type != VIS_CHAR) ? _int_type(field->size) : NULL;
+            if (type) {
+                fprintf(out, "    %-8s %s;\n", type, vis_str(field->name));
+            } else {
+                fprintf(out, "    %-8s %s[%u];\n", "uint8_t", vis_str(field->name), (unsigned int)field->size);
+            }
+        }
+        fprintf(out, "} schema_%s_t;\n\n", ident);
+        char upper[MAX_IDENT_LEN + 1];
+        size_t k = 0;
+        for (; ident[k]; k++) {
+            upper[k] = (char)toupper((unsigned char)ident[k]);
+        }
+        upper[k] = '\0';
+        fprintf(out, "#define SCHEMA_%s_SIZE %u\n\n", upper, (unsigned int)st->size);
+
+        fprintf(out, "bool schema_read_%s(const pe_image_t *image, size_t offset, schema_%s_t *record);\n", ident, ident);
+        for (size_t j = 0; j < st->fields.size; j++) {
+            const vis_field_t *field = store_pget(&st->fields, j);
+            if (field->valid_values.size > 0 && field->type == VIS_FLAG) {
+                _field_ident(vis_str(field->name), fident);
+                fprintf(out, "size_t schema_%s_%s_flags(vis_value_t value, char *buffer, size_t size);\n", ident, fident);
+            } else if (field->valid_values.size > 0) {
+                _field_ident(vis_str(field->name), fident);
+                fprintf(out, "const char * schema_%s_%s_name(vis_value_t value);\n", ident, fident);
+            }
+        }
+        fprintf(out, "\n");
+    }
+
+    fprintf(out, "// Regenerate after editing std/*.petc: the project build runs \"petool schema\n"
+                 "// codegen\" with the petool of the previous build, or run it by hand with the\n"
+                 "// petc files in the order main.c loads them.\n");
+    fprintf(out, "void schema_gen_register();\n\n#endif\n");
+}
+
+// Name lookup of one field: one case per distinct value, the first one defined wins
+static void _write_name_fn(FILE *out, const char *ident, const vis_field_t *field)
+{
+    char fident[MAX_IDENT_LEN + 1];
+    _field_ident(vis_str(field->name), fident);
+
+    fprintf(out, "const char * schema_%s_%s_name(vis_value_t value)\n{\n    switch (value)\n    {\n", ident, fident);
+    for (size_t k = 0; k < field->valid_values.size; k++) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, k);
+        bool seen = false;
+        for (size_t m = 0; m < k && !seen; m++) {
+            seen = (((const vis_value_info_t *)store_pget(&field->valid_values, m))->value == vi->value);
+        }
+        if (!seen) {
+            fprintf(out, "        case 0x%llx: return ", (unsigned long long)vi->value);
+            _put_string(out, vis_str(vi->name));
+            fprintf(out, ";\n");
+        }
+    }
+    fprintf(out, "    }\n    return NULL;\n}\n\n");
+}
+
+// Flag decomposition of one field: a switch on each set bit appends the names
+// of that bit's values, in order of definition. Values of several bits follow,
+// each matching if any of its bits is set, as in vis_field_value_str.
+static void _write_flags_fn(FILE *out, const char *ident, const vis_field_t *field)
+{
+    char fident[MAX_IDENT_LEN + 1];
+    _field_ident(vis_str(field->name), fident);
+
+    fprintf(out, "size_t schema_%s_%s_flags(vis_value_t value, char *buffer, size_t size)\n{\n", ident, fident);
+    fprintf(out, "    size_t pos = 0;\n    for (vis_value_t bits = value; bits; bits &= bits - 1) {\n"
+                 "        switch (bits & (~bits + 1))\n        {\n");
+    for (size_t k = 0; k < field->valid_values.size; k++) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, k);
+        if (vi->value == 0 || (vi->value & (vi->value - 1)) != 0) {
+            continue;
+        }
+        bool seen = false;
+        for (size_t m = 0; m < k && !seen; m++) {
+            seen = (((const vis_value_info_t *)store_pget(&field->valid_values, m))->value == vi->value);
+        }
+        if (seen) {
+            continue;
+        }
+
+        // All names of the bit in one string
+        fprintf(out, "            case 0x%llx: pos = vis_append_str(buffer, size, pos, \"", (unsigned long long)vi->value);
+        for (size_t m = k; m < field->valid_values.size; m++) {
+            const vis_value_info_t *other = store_pget(&field->valid_values, m);
+            if (other->value == vi->value) {
+                _put_chars(out, vis_str(other->name));
+                fprintf(out, " ");
+            }
+        }
+        fprintf(out, "\"); break;\n");
+    }
+    fprintf(out, "        }\n    }\n");
+    for (size_t k = 0; k < field->valid_values.size; k++) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, k);
+        if (vi->value != 0 && (vi->value & (vi->value - 1)) != 0) {
+            fprintf(out, "    if (value & 0x%llx) {\n        pos = vis_append_str(buffer, size, pos, \"",
+                (unsigned long long)vi->value);
+            _put_chars(out, vis_str(vi->name));
+            fprintf(out, " \");\n    }\n");
+        }
+    }
+    fprintf(out, "    if (pos == 0 && size > 0) {\n        buffer[0] = '\\0';\n    }\n    return pos;\n}\n\n");
+}
+
+static void _write_struct(FILE *out, const vis_struct_t *st)
+{
+    char ident[MAX_IDENT_LEN + 1];
+    _struct_ident(vis_str(st->name), ident);
+
+    // Typed reader: one bounds check, then loads at constant offsets
+    fprintf(out, "bool schema_read_%s(const pe_image_t *image, size_t offset, schema_%s_t *record)\n{\n", ident, ident);
+    fprintf(out, "    const uint8_t *data = image_ptr(image, offset, %u);\n", (unsigned int)st->size);
+    fprintf(out, "    if (!data) {\n        set_error(\"Read past the end of image\");\n        return false;\n    }\n");
+    for (size_t j = 0; j < st->fields.size; j++) {
+        const vis_field_t *field = store_pget(&st->fields, j);
+        if (field->type != VIS_CHAR && _int_type(field->size)) {
+            fprintf(out, "    memcpy(&record->%s, data + %u, %u);\n", vis_str(field->name),
+                (unsigned int)field->offset, (unsigned int)field->size);
+        } else {
+            fprintf(out, "    memcpy(record->%s, data + %u, %u);\n", vis_str(field->name),
+                (unsigned int)field->offset, (unsigned int)field->size);
+        }
+    }
+    fprintf(out, "    return true;\n}\n\n");
+
+    // Decoder for vis_read_struct. Fields of other sizes decode as zero, as in vis_read_value.
+    fprintf(out, "static void _decode_%s(const uint8_t *data, vis_value_t *values)\n{\n", ident);
+    for (size_t j = 0; j < st->fields.size; j++) {
+        const vis_field_t *field = store_pget(&st->fields, j);
+        if (_int_type(field->size)) {
+            fprintf(out, "    values[%u] = _load_u%u(data + %u);\n", (unsigned int)j,
+                (unsigned int)field->size * 8, (unsigned int)field->offset);
+        } else {
+            fprintf(out, "    values[%u] = 0;\n", (unsigned int)j);
+        }
+    }
+    fprintf(out, "}\n\n");
+
+    // Layout the decoder was generated for
+    fprintf(out, "static const schema_field_layout_t _layout_%s[] = {\n", ident);
+    for (size_t j = 0; j < st->fields.size; j++) {
+        const vis_field_t *field = store_pget(&st->fields, j);
+        fprintf(out, "    { ");
+        _put_string(out, vis_str(field->name));
+        fprintf(out, ", %u, %u, ", (unsigned int)field->offset, (unsigned int)field->size);
+        char fident[MAX_IDENT_LEN + 1];
+        _field_ident(vis_str(field->name), fident);
+        if (field->valid_values.size > 0 && field->type == VIS_ENUM) {
+            fprintf(out, "schema_%s_%s_name, NULL", ident, fident);
+        } else if (field->valid_values.size > 0 && field->type == VIS_FLAG) {
+            fprintf(out, "NULL, schema_%s_%s_flags", ident, fident);
+        } else {
+            fprintf(out, "NULL, NULL");
+        }
+        fprintf(out, " },\n");
+    }
+    if (st->fields.size == 0) {
+        fprintf(out, "    { NULL, 0, 0, NULL, NULL },\n");
+    }
+    fprintf(out, "};\n\n");
+
+    for (size_t j = 0; j < st->fields.size; j++) {
+        const vis_field_t *field = store_pget(&st->fields, j);
+        if (field->valid_values.size > 0 && field->type == VIS_FLAG) {
+            _write_flags_fn(out, ident, field);
+        } else if (field->valid_values.size > 0) {
+            _write_name_fn(out, ident, field);
+        }
+    }
+}
+
+static void _write_source(FILE *out, const char *h_name)
+{
+    fprintf(out, "// Generated from petc schemas by \"petool schema codegen\". Do not edit.\n\n");
+    fprintf(out, "#include <string.h>\n#include \"%s\"\n#include \"error.h\"\n\n", h_name);
+
+    fprintf(out, "typedef struct\n{\n    const char *name;\n    size_t offset;\n    size_t size;\n"
+                 "    vis_value_name_fn_t value_name;\n    vis_flag_names_fn_t flag_names;\n} schema_field_layout_t;\n\n");
+    fprintf(out, "typedef struct\n{\n    const char *name;\n    size_t size;\n    size_t field_num;\n"
+                 "    const schema_field_layout_t *fields;\n    vis_decode_fn_t decode;\n} schema_struct_layout_t;\n\n");
+
+    for (unsigned int bits = 8; bits <= 64; bits *= 2) {
+        fprintf(out, "static __inline vis_value_t _load_u%u(const uint8_t *p)\n{\n    uint%u_t v;\n"
+                     "    memcpy(&v, p, %u);\n    return v;\n}\n\n", bits, bits, bits / 8);
+    }
+
+    // Name lookups are declared in the header, so layout tables may refer to them
+    char ident[MAX_IDENT_LEN + 1];
+    for (size_t i = 0; i < vis_struct_num(); i++) {
+        _write_struct(out, vis_get_struct(i));
+    }
+
+    fprintf(out, "static const schema_struct_layout_t _layouts[] = {\n");
+    for (size_t i = 0; i < vis_struct_num(); i++) {
+        const vis_struct_t *st = vis_get_struct(i);
+        _struct_ident(vis_str(st->name), ident);
+        fprintf(out, "    { ");
+        _put_string(out, vis_str(st->name));
+        fprintf(out, ", %u, %u, _layout_%s, _decode_%s },\n", (unsigned int)st->size,
+            (unsigned int)st->fields.size, ident, ident);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out,
+        "// Attach generated decoders and value names to the loaded schema. Structures\n"
+        "// whose layout differs from the generated one keep the interpretive decoder.\n"
+        "void schema_gen_register()\n"
+        "{\n"
+        "    for (size_t i = 0; i < sizeof(_layouts) / sizeof(_layouts[0]); i++) {\n"
+        "        const schema_struct_layout_t *layout = &_layouts[i];\n"
+        "        vis_struct_t *st = vis_find_struct(layout->name);\n"
+        "        if (!st || st->size != layout->size || st->fields.size != layout->field_num) {\n"
+        "            continue;\n"
+        "        }\n"
+        "\n"
+        "        bool same = true;\n"
+        "        for (size_t j = 0; j < layout->field_num && same; j++) {\n"
+        "            const vis_field_t *field = store_pget(&st->fields, j);\n"
+        "            same = (field->offset == layout->fields[j].offset && field->size == layout->fields[j].size &&\n"
+        "                strcmp(vis_str(field->name), layout->fields[j].name) == 0);\n"
+        "        }\n"
+        "        if (!same) {\n"
+        "            continue;\n"
+        "        }\n"
+        "\n"
+        "        st->decode = layout->decode;\n"
+        "        for (size_t j = 0; j < layout->field_num; j++) {\n"
+        "            vis_field_t *field = store_pget(&st->fields, j);\n"
+        "            field->value_name = layout->fields[j].value_name;\n"
+        "            field->flag_names = layout->fields[j].flag_names;\n"
+        "        }\n"
+        "    }\n"
+        "}\n");
+}
+
+// Generated header guard: file name in upper case
+static void _guard(const char *fname, char *guard, size_t size)
+{
+    const char *base = fname;
+    for (const char *p = fname; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    size_t len = 0;
+    for (const char *p = base; *p && len + 1 < size; p++) {
+        guard[len++] = isalnum((unsigned char)*p) ? (char)toupper((unsigned char)*p) : '_';
+    }
+    guard[len] = '\0';
+}
+
+// Write decoders of all loaded structures into a C source and its header
+bool codegen_write(const char *c_fname, const char *h_fname)
+{
+    char guard[MAX_IDENT_LEN + 1];
+    _guard(h_fname, guard, sizeof(guard));
+
+    FILE *out = NULL;
+    if (fopen_s(&out, h_fname, "w")) {
+        set_error("Failed to create generated header");
+        return false;
+    }
+    _write_header(out, guard);
+    if (fclose(out)) {
+        set_error("Failed to write generated header");
+        return false;
+    }
+
+    const char *h_name = h_fname;
+    for (const char *p = h_fname; *p; p++) {
+        if (*p == '/' || *p == '\\') {
+            h_name = p + 1;
+        }
+    }
+
+    if (fopen_s(&out, c_fname, "w")) {
+        set_error("Failed to create generated source");
+        return false;
+    }
+    _write_source(out, h_name);
+    if (fclose(out)) {
+        set_error("Failed to write generated source");
+        return false;
+    }
+    return true;
+}
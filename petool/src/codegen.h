@@ -0,0 +1,17 @@
+/**
+ * @file
+ *
+ * Generator of C decoders from the loaded schema. Every structure gets a
+ * typed record with a reader doing fixed-offset loads, a decoder for
+ * vis_read_struct, and a switch-based name lookup for each ENUM field or
+ * flag decomposition for each FLAG field with valid values.
+ */
+
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include <stdbool.h>
+
+bool codegen_write(const char *c_fname, const char *h_fname);
+
+#endif
@@ -0,0 +1,11 @@
+#include "coff_header.h"
+#include "error.h"
+
+bool read_coff_file_header(const pe_image_t *image, size_t offset, coff_file_header_t *header)
+{
+    if (!image_read(image, offset, header, COFF_FILE_HEADER_SIZE)) {
+        set_error("Failed to read COFF File Header");
+        return false;
+    }
+    return true;
+}
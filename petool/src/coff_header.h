@@ -0,0 +1,49 @@
+#ifndef COFF_HEADER_H
+#define COFF_HEADER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+
+#define COFF_FILE_HEADER_SIZE 20
+
+// COFF File Header, follows PE signature in images and starts object files
+typedef struct {
+    uint16_t Machine;
+    uint16_t NumberOfSections;
+    uint32_t TimeDateStamp;
+    uint32_t PointerToSymbolTable;
+    uint32_t NumberOfSymbols;
+    uint16_t SizeOfOptionalHeader;
+    uint16_t Characteristics;
+} coff_file_header_t;
+
+// Machine types that select a relocation type table
+typedef enum {
+    IMAGE_FILE_MACHINE_I386      = 0x014C,
+    IMAGE_FILE_MACHINE_R3000     = 0x0162,
+    IMAGE_FILE_MACHINE_R4000     = 0x0166,
+    IMAGE_FILE_MACHINE_R10000    = 0x0168,
+    IMAGE_FILE_MACHINE_WCEMIPSV2 = 0x0169,
+    IMAGE_FILE_MACHINE_SH3       = 0x01A2,
+    IMAGE_FILE_MACHINE_SH3DSP    = 0x01A3,
+    IMAGE_FILE_MACHINE_SH3E      = 0x01A4,
+    IMAGE_FILE_MACHINE_SH4       = 0x01A6,
+    IMAGE_FILE_MACHINE_ARM       = 0x01C0,
+    IMAGE_FILE_MACHINE_THUMB     = 0x01C2,
+    IMAGE_FILE_MACHINE_ARMNT     = 0x01C4,
+    IMAGE_FILE_MACHINE_POWERPC   = 0x01F0,
+    IMAGE_FILE_MACHINE_POWERPCFP = 0x01F1,
+    IMAGE_FILE_MACHINE_IA64      = 0x0200,
+    IMAGE_FILE_MACHINE_MIPS16    = 0x0266,
+    IMAGE_FILE_MACHINE_MIPSFPU   = 0x0366,
+    IMAGE_FILE_MACHINE_MIPSFPU16 = 0x0466,
+    IMAGE_FILE_MACHINE_AMD64     = 0x8664,
+    IMAGE_FILE_MACHINE_M32R      = 0x9041,
+    IMAGE_FILE_MACHINE_ARM64     = 0xAA64,
+} coff_machine_t;
+
+bool read_coff_file_header(const pe_image_t *image, size_t offset, coff_file_header_t *header);
+
+#endif
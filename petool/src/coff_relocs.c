@@ -0,0 +1,111 @@
+#include <string.h>
+#include "coff_relocs.h"
+#include "schema_gen.h"
+#include "error.h"
+
+// Pick the relocation type table of a machine, one of the variations of
+// COFF_Relocation in coff-relocations.petc
+static vis_value_name_fn_t _type_names(uint16_t machine)
+{
+    switch (machine) {
+    case IMAGE_FILE_MACHINE_AMD64:
+        return schema_coff_relocation_amd64_type_name;
+    case IMAGE_FILE_MACHINE_ARM:
+    case IMAGE_FILE_MACHINE_THUMB:
+    case IMAGE_FILE_MACHINE_ARMNT:
+        return schema_coff_relocation_arm_type_name;
+    case IMAGE_FILE_MACHINE_ARM64:
+        return schema_coff_relocation_arm64_type_name;
+    case IMAGE_FILE_MACHINE_SH3:
+    case IMAGE_FILE_MACHINE_SH3DSP:
+    case IMAGE_FILE_MACHINE_SH3E:
+    case IMAGE_FILE_MACHINE_SH4:
+        return schema_coff_relocation_sh3_type_name;
+    case IMAGE_FILE_MACHINE_POWERPC:
+    case IMAGE_FILE_MACHINE_POWERPCFP:
+        return schema_coff_relocation_ppc_type_name;
+    case IMAGE_FILE_MACHINE_I386:
+        return schema_coff_relocation_i386_type_name;
+    case IMAGE_FILE_MACHINE_IA64:
+        return schema_coff_relocation_ia64_type_name;
+    case IMAGE_FILE_MACHINE_R3000:
+    case IMAGE_FILE_MACHINE_R4000:
+    case IMAGE_FILE_MACHINE_R10000:
+    case IMAGE_FILE_MACHINE_WCEMIPSV2:
+    case IMAGE_FILE_MACHINE_MIPS16:
+    case IMAGE_FILE_MACHINE_MIPSFPU:
+    case IMAGE_FILE_MACHINE_MIPSFPU16:
+        return schema_coff_relocation_mips_type_name;
+    case IMAGE_FILE_MACHINE_M32R:
+        return schema_coff_relocation_m32r_type_name;
+    default:
+        return NULL;
+    }
+}
+
+void coff_reloc_file_init(coff_reloc_file_t *file, const pe_image_t *image, const coff_file_header_t *coff)
+{
+    file->image = image;
+    file->machine = coff->Machine;
+    file->type_name = _type_names(coff->Machine);
+}
+
+// Locate the relocations of a section. With IMAGE_SCN_LNK_NRELOC_OVFL, the
+// count, including the record holding it, is in the VirtualAddress of the
+// first record, which is skipped.
+bool read_section_relocs(const coff_reloc_file_t *file, const section_header_t *section, coff_relocs_t *relocs)
+{
+    relocs->file = file;
+    relocs->data = NULL;
+    relocs->num = section->NumberOfRelocations;
+
+    size_t offset = section->PointerToRelocations;
+    if ((section->Characteristics & IMAGE_SCN_LNK_NRELOC_OVFL) && section->NumberOfRelocations == 0xFFFF) {
+        uint32_t num;
+        if (!image_read_u32(file->image, offset, &num) || num == 0) {
+            set_error("Invalid extended relocation count");
+            relocs->num = 0;
+            return false;
+        }
+        relocs->num = num - 1;
+        offset += COFF_RELOCATION_SIZE;
+    }
+    if (relocs->num == 0) {
+        return true;
+    }
+
+    uint64_t size = (uint64_t)relocs->num * COFF_RELOCATION_SIZE;
+    relocs->data = (size <= file->image->size) ? image_ptr(file->image, offset, (size_t)size) : NULL;
+    if (!relocs->data) {
+        set_error("Section relocations are out of file");
+        relocs->num = 0;
+        return false;
+    }
+    return true;
+}
+
+// Decode up to num relocations starting at first into dest, returns the
+// number decoded
+size_t coff_relocs_decode(const coff_relocs_t *relocs, size_t first, size_t num, coff_relocation_t *dest)
+{
+    if (first >= relocs->num) {
+        return 0;
+    }
+    if (num > relocs->num - first) {
+        num = relocs->num - first;
+    }
+
+    const uint8_t *p = relocs->data + first * COFF_RELOCATION_SIZE;
+    for (size_t i = 0; i < num; i++, p += COFF_RELOCATION_SIZE) {
+        memcpy(&dest[i].VirtualAddress, p, 4);
+        memcpy(&dest[i].SymbolTableIndex, p + 4, 4);
+        memcpy(&dest[i].Type, p + 8, 2);
+    }
+    return num;
+}
+
+// Name of a relocation type for the file's machine, NULL if unknown
+const char * coff_reloc_type_name(const coff_reloc_file_t *file, uint16_t type)
+{
+    return file->type_name ? file->type_name(type) : NULL;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file
+ *
+ * Decoder of the relocations attached to sections of object files. The
+ * relocation array of a section is located once and decoded in bulk, and the
+ * table of type names for the file's machine is picked once per file from the
+ * generated schema decoders.
+ */
+
+#ifndef COFF_RELOCS_H
+#define COFF_RELOCS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "coff_header.h"
+#include "section_table.h"
+#include "vis_struct.h"
+
+#define COFF_RELOCATION_SIZE 10
+
+// COFF Relocation
+typedef struct {
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} coff_relocation_t;
+
+// Per-file relocation context
+typedef struct
+{
+    const pe_image_t   *image;
+    uint16_t            machine;
+    vis_value_name_fn_t type_name;  // names of Type values, NULL for unknown machines
+} coff_reloc_file_t;
+
+// Relocation array of one section, still in the file
+typedef struct
+{
+    const coff_reloc_file_t *file;
+    const uint8_t           *data;  // num unaligned records of COFF_RELOCATION_SIZE bytes
+    size_t                   num;
+} coff_relocs_t;
+
+void coff_reloc_file_init(coff_reloc_file_t *file, const pe_image_t *image, const coff_file_header_t *coff);
+bool read_section_relocs(const coff_reloc_file_t *file, const section_header_t *section, coff_relocs_t *relocs);
+size_t coff_relocs_decode(const coff_relocs_t *relocs, size_t first, size_t num, coff_relocation_t *dest);
+const char * coff_reloc_type_name(const coff_reloc_file_t *file, uint16_t type);
+
+#endif
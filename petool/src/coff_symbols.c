@@ -0,0 +1,172 @@
+#include <stdint.h>
+#include <string.h>
+#include "coff_symbols.h"
+#include "error.h"
+
+#define COFF_STRING_TABLE_SIZE_SIZE 4
+
+// Locate the symbol table and the string table that follows it. Fails
+// without an error set if the file has no symbol table.
+bool read_coff_symbols(const pe_image_t *image, const coff_file_header_t *coff, coff_symbols_t *symbols)
+{
+    memset(symbols, 0, sizeof(coff_symbols_t));
+    symbols->image = image;
+    name_index_t index = name_index_init();
+    symbols->index = index;
+
+    if (coff->PointerToSymbolTable == 0 || coff->NumberOfSymbols == 0) {
+        return false;
+    }
+    uint64_t table_size64 = (uint64_t)coff->NumberOfSymbols * COFF_SYMBOL_SIZE;
+    if (table_size64 > image->size) {
+        set_error("Symbol table is out of file");
+        return false;
+    }
+    size_t table_size = (size_t)table_size64;
+    symbols->symbols = image_ptr(image, coff->PointerToSymbolTable, table_size);
+    if (!symbols->symbols) {
+        set_error("Symbol table is out of file");
+        return false;
+    }
+    symbols->symbol_num = coff->NumberOfSymbols;
+
+    // The size of the string table includes the size field itself. Files
+    // without long names may omit the table or cut it short.
+    size_t strings_offset = (size_t)coff->PointerToSymbolTable + table_size;
+    uint32_t string_size = 0;
+    if (image_has(image, strings_offset, COFF_STRING_TABLE_SIZE_SIZE)) {
+        memcpy(&string_size, image->data + strings_offset, 4);
+    }
+    if (string_size < COFF_STRING_TABLE_SIZE_SIZE) {
+        string_size = 0;
+    } else if (string_size > image->size - strings_offset) {
+        string_size = (uint32_t)(image->size - strings_offset);
+    }
+    symbols->strings = image->data + strings_offset;
+    symbols->string_size = string_size;
+    return true;
+}
+
+void coff_symbols_free(coff_symbols_t *symbols)
+{
+    name_index_free(&symbols->index);
+}
+
+// Decode a symbol record. Fails with an error set if the index is not in the
+// table, or the record is damaged.
+bool coff_symbol_at(const coff_symbols_t *symbols, uint32_t index, coff_symbol_t *symbol)
+{
+    if (index >= symbols->symbol_num) {
+        set_error("Symbol index is out of symbol table");
+        return false;
+    }
+
+    const uint8_t *p = symbols->symbols + (size_t)index * COFF_SYMBOL_SIZE;
+    symbol->index = index;
+    memcpy(&symbol->Value, p + 8, 4);
+    memcpy(&symbol->SectionNumber, p + 12, 2);
+    memcpy(&symbol->Type, p + 14, 2);
+    symbol->StorageClass = p[16];
+    symbol->NumberOfAuxSymbols = p[17];
+    symbol->aux = p + COFF_SYMBOL_SIZE;
+    if (symbol->NumberOfAuxSymbols > symbols->symbol_num - index - 1) {
+        set_error("Auxiliary symbols are out of symbol table");
+        return false;
+    }
+
+    uint32_t zeroes;
+    memcpy(&zeroes, p, 4);
+    if (zeroes != 0) {
+        // Short name, NUL-padded to 8 bytes
+        const char *end = memchr(p, '\0', 8);
+        symbol->name.str = (const char *)p;
+        symbol->name.len = end ? (size_t)(end - (const char *)p) : 8;
+        return true;
+    }
+
+    uint32_t offset;
+    memcpy(&offset, p + 4, 4);
+    const char *str = (const char *)symbols->strings + offset;
+    const char *end = NULL;
+    if (offset >= COFF_STRING_TABLE_SIZE_SIZE && offset < symbols->string_size) {
+        end = memchr(str, '\0', symbols->string_size - offset);
+    }
+    if (!end) {
+        set_error("Symbol name is out of string table");
+        return false;
+    }
+    symbol->name.str = str;
+    symbol->name.len = (size_t)(end - str);
+    return true;
+}
+
+// Copy an auxiliary record of a symbol
+bool coff_aux_symbol(const coff_symbol_t *symbol, uint8_t idx, aux_symbol_record_t *aux)
+{
+    if (idx >= symbol->NumberOfAuxSymbols) {
+        set_error("Auxiliary symbol index is out of range");
+        return false;
+    }
+    memset(aux, 0, sizeof(aux_symbol_record_t));
+    memcpy(aux, symbol->aux + (size_t)idx * COFF_SYMBOL_SIZE, COFF_SYMBOL_SIZE);
+    return true;
+}
+
+void coff_symbol_iter_init(coff_symbol_iter_t *it, const coff_symbols_t *symbols)
+{
+    it->symbols = symbols;
+    it->next = 0;
+}
+
+// Decode the next symbol, skipping auxiliary records of the previous one.
+// Returns false after the last symbol, and also with an error set if the
+// table is damaged.
+bool coff_next_symbol(coff_symbol_iter_t *it, coff_symbol_t *symbol)
+{
+    if (it->next >= it->symbols->symbol_num) {
+        return false;
+    }
+    if (!coff_symbol_at(it->symbols, it->next, symbol)) {
+        it->next = it->symbols->symbol_num;
+        return false;
+    }
+    it->next += 1 + symbol->NumberOfAuxSymbols;
+    return true;
+}
+
+static const char * _symbol_name(const void *ctx, size_t idx, size_t *len)
+{
+    coff_symbol_t symbol;
+    if (!coff_symbol_at(ctx, (uint32_t)idx, &symbol)) {
+        *len = 0;
+        return "";
+    }
+    *len = symbol.name.len;
+    return symbol.name.str;
+}
+
+// Build the name index in one pass over the table. The index holds only
+// hashes and symbol indices, names stay in the file. If names repeat, the
+// first symbol is found.
+bool coff_symbols_index(coff_symbols_t *symbols)
+{
+    name_index_free(&symbols->index);
+
+    coff_symbol_iter_t it;
+    coff_symbol_t symbol;
+    coff_symbol_iter_init(&it, symbols);
+    while (coff_next_symbol(&it, &symbol)) {
+        name_index_add(&symbols->index, symbol.name.str, symbol.name.len, symbol.index);
+    }
+    return !has_error();
+}
+
+// Find a symbol by name with the index built by coff_symbols_index
+bool coff_find_symbol(const coff_symbols_t *symbols, const char *name, coff_symbol_t *symbol)
+{
+    size_t idx;
+    if (!name_index_find_len(&symbols->index, name, strlen(name), _symbol_name, symbols, &idx)) {
+        return false;
+    }
+    return coff_symbol_at(symbols, (uint32_t)idx, symbol);
+}
@@ -0,0 +1,204 @@
+/**
+ * @file
+ *
+ * COFF symbol table decoder for object files and images. Symbols are decoded
+ * one 18-byte record at a time with their auxiliary records skipped, and long
+ * names are resolved as slices of the string table, so streaming needs no
+ * memory per symbol. An optional hash index maps names to symbol indices.
+ */
+
+#ifndef COFF_SYMBOLS_H
+#define COFF_SYMBOLS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "coff_header.h"
+#include "name_index.h"
+
+#define COFF_SYMBOL_SIZE 18
+
+// Symbol table and string table of a COFF file
+typedef struct
+{
+    const pe_image_t *image;
+    const uint8_t    *symbols;      // NumberOfSymbols records of COFF_SYMBOL_SIZE bytes
+    uint32_t          symbol_num;
+    const uint8_t    *strings;      // string table, starting with its 4-byte size
+    size_t            string_size;
+    name_index_t      index;        // built by coff_symbols_index
+} coff_symbols_t;
+
+// Decoded Symbol Table record
+typedef struct
+{
+    uint32_t       index;           // position in the symbol table
+    image_str_t    name;            // short name or slice of the string table
+    uint32_t       Value;
+    int16_t        SectionNumber;   // 1-based, or one of IMAGE_SYM_UNDEFINED/ABSOLUTE/DEBUG
+    uint16_t       Type;
+    uint8_t        StorageClass;
+    uint8_t        NumberOfAuxSymbols;
+    const uint8_t *aux;             // first of NumberOfAuxSymbols records that follow
+} coff_symbol_t;
+
+// Position in the symbol table
+typedef struct
+{
+    const coff_symbols_t *symbols;
+    uint32_t              next;
+} coff_symbol_iter_t;
+
+// Section Number Values
+#define IMAGE_SYM_UNDEFINED           0                 // Symbol is undefined or is common.
+#define IMAGE_SYM_ABSOLUTE            -1                // Symbol is an absolute value.
+#define IMAGE_SYM_DEBUG               -2                // Symbol is a special debug item.
+
+//
+// Section Types
+// Type (fundamental) values.
+#define IMAGE_SYM_TYPE_NULL                 0x0000  // no type.
+#define IMAGE_SYM_TYPE_VOID                 0x0001  //
+#define IMAGE_SYM_TYPE_CHAR                 0x0002  // type character.
+#define IMAGE_SYM_TYPE_SHORT                0x0003  // type short integer.
+#define IMAGE_SYM_TYPE_INT                  0x0004  //
+#define IMAGE_SYM_TYPE_LONG                 0x0005  //
+#define IMAGE_SYM_TYPE_FLOAT                0x0006  //
+#define IMAGE_SYM_TYPE_DOUBLE               0x0007  //
+#define IMAGE_SYM_TYPE_STRUCT               0x0008  //
+#define IMAGE_SYM_TYPE_UNION                0x0009  //
+#define IMAGE_SYM_TYPE_ENUM                 0x000A  // enumeration.
+#define IMAGE_SYM_TYPE_MOE                  0x000B  // member of enumeration.
+#define IMAGE_SYM_TYPE_BYTE                 0x000C  //
+#define IMAGE_SYM_TYPE_WORD                 0x000D  //
+#define IMAGE_SYM_TYPE_UINT                 0x000E  //
+#define IMAGE_SYM_TYPE_DWORD                0x000F  //
+#define IMAGE_SYM_TYPE_PCODE                0x8000  //
+
+//
+// Type (derived) values.
+//
+#define IMAGE_SYM_DTYPE_NULL                0       // no derived type.
+#define IMAGE_SYM_DTYPE_POINTER             1       // pointer.
+#define IMAGE_SYM_DTYPE_FUNCTION            2       // function.
+#define IMAGE_SYM_DTYPE_ARRAY               3       // array.
+
+
+
+//
+// Symbol Table Storage Classes
+// Storage classes.
+//
+#define IMAGE_SYM_CLASS_END_OF_FUNCTION     0xFF
+#define IMAGE_SYM_CLASS_NULL                0x0000
+#define IMAGE_SYM_CLASS_AUTOMATIC           0x0001
+#define IMAGE_SYM_CLASS_EXTERNAL            0x0002
+#define IMAGE_SYM_CLASS_STATIC              0x0003
+#define IMAGE_SYM_CLASS_REGISTER            0x0004
+#define IMAGE_SYM_CLASS_EXTERNAL_DEF        0x0005
+#define IMAGE_SYM_CLASS_LABEL               0x0006
+#define IMAGE_SYM_CLASS_UNDEFINED_LABEL     0x0007
+#define IMAGE_SYM_CLASS_MEMBER_OF_STRUCT    0x0008
+#define IMAGE_SYM_CLASS_ARGUMENT            0x0009
+#define IMAGE_SYM_CLASS_STRUCT_TAG          0x000A
+#define IMAGE_SYM_CLASS_MEMBER_OF_UNION     0x000B
+#define IMAGE_SYM_CLASS_UNION_TAG           0x000C
+#define IMAGE_SYM_CLASS_TYPE_DEFINITION     0x000D
+#define IMAGE_SYM_CLASS_UNDEFINED_STATIC    0x000E
+#define IMAGE_SYM_CLASS_ENUM_TAG            0x000F
+#define IMAGE_SYM_CLASS_MEMBER_OF_ENUM      0x0010
+#define IMAGE_SYM_CLASS_REGISTER_PARAM      0x0011
+#define IMAGE_SYM_CLASS_BIT_FIELD           0x0012
+
+#define IMAGE_SYM_CLASS_FAR_EXTERNAL        0x0044  //
+
+#define IMAGE_SYM_CLASS_BLOCK               0x0064
+#define IMAGE_SYM_CLASS_FUNCTION            0x0065
+#define IMAGE_SYM_CLASS_END_OF_STRUCT       0x0066
+#define IMAGE_SYM_CLASS_FILE                0x0067
+// new
+#define IMAGE_SYM_CLASS_SECTION             0x0068
+#define IMAGE_SYM_CLASS_WEAK_EXTERNAL       0x0069
+
+#define IMAGE_SYM_CLASS_CLR_TOKEN           0x006B
+
+// Auxiliary Symbol Table record, always 18 bytes
+typedef union {
+    // Auxiliary Format 1: Function Definitions
+    struct {
+        uint32_t TagIndex;
+        uint32_t TotalSize;
+        uint32_t PointerToLinenumber;
+        uint32_t PointerToNextFunction;
+        uint16_t Unused;
+    } FuncDef;
+
+    // Auxiliary Format 2: .bf and .ef Symbols
+    struct {
+        uint32_t Unused_1;
+        uint16_t Linenumber;
+        uint16_t Unused_2;
+        uint32_t Unused_3;
+        uint32_t PointerToNextFunction;
+        uint16_t Unused_4;
+    } BfEf;
+
+    // Auxiliary Format 3: Weak Externals
+    struct {
+        uint32_t TagIndex;
+        uint32_t Characteristics;
+        uint32_t Unused_1;
+        uint32_t Unused_2;
+        uint16_t Unused_3;
+    } WeakExternals;
+
+    // Auxiliary Format 4: Files
+    uint8_t FileName[18];
+
+    // Auxiliary Format 5: Section Definitions
+    struct {
+        uint32_t Length;
+        uint16_t NumberOfRelocations;
+        uint16_t NumberOfLinenumbers;
+        uint32_t CheckSum;
+        uint16_t Number;
+        uint8_t  Selection;
+        uint8_t  Unused[3];
+    } SectionDef;
+} aux_symbol_record_t;
+
+
+//
+// Aux Format 5 (Section Definitions) Selection field
+// Communal selection types.
+//
+#define IMAGE_COMDAT_SELECT_NODUPLICATES    1
+#define IMAGE_COMDAT_SELECT_ANY             2
+#define IMAGE_COMDAT_SELECT_SAME_SIZE       3
+#define IMAGE_COMDAT_SELECT_EXACT_MATCH     4
+#define IMAGE_COMDAT_SELECT_ASSOCIATIVE     5
+#define IMAGE_COMDAT_SELECT_LARGEST         6
+#define IMAGE_COMDAT_SELECT_NEWEST          7
+
+// CLR Toke Definition (Auxiliary Symbol token)
+typedef struct {
+    uint8_t  bAuxType;                  // IMAGE_AUX_SYMBOL_TYPE
+    uint8_t  bReserved;                 // Must be 0
+    uint32_t SymbolTableIndex;
+    uint8_t  rgbReserved[12];           // Must be 0
+} aux_symbol_token_t;
+
+bool read_coff_symbols(const pe_image_t *image, const coff_file_header_t *coff, coff_symbols_t *symbols);
+void coff_symbols_free(coff_symbols_t *symbols);
+
+bool coff_symbol_at(const coff_symbols_t *symbols, uint32_t index, coff_symbol_t *symbol);
+bool coff_aux_symbol(const coff_symbol_t *symbol, uint8_t idx, aux_symbol_record_t *aux);
+
+void coff_symbol_iter_init(coff_symbol_iter_t *it, const coff_symbols_t *symbols);
+bool coff_next_symbol(coff_symbol_iter_t *it, coff_symbol_t *symbol);
+
+bool coff_symbols_index(coff_symbols_t *symbols);
+bool coff_find_symbol(const coff_symbols_t *symbols, const char *name, coff_symbol_t *symbol);
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * @file
+ *
+ * Compiler-specific keywords and intrinsics
+ */
+
+#ifndef COMPAT_H
+#define COMPAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Storage class for per-thread variables
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL _Thread_local
+#endif
+
+// Index of the lowest set bit of a nonzero value
+#ifdef _MSC_VER
+#include <intrin.h>
+static __inline unsigned int bit_index(uint64_t value)
+{
+    unsigned long idx;
+    if (_BitScanForward(&idx, (unsigned long)value)) {
+        return idx;
+    }
+    _BitScanForward(&idx, (unsigned long)(value >> 32));
+    return idx + 32;
+}
+#else
+static __inline unsigned int bit_index(uint64_t value)
+{
+    return (unsigned int)__builtin_ctzll(value);
+}
+#endif
+
+// AVX2 kernels are compiled on x86 with TARGET_AVX2 on the function, and
+// called only if cpu_has_avx2() says the CPU and the OS support them. MSVC
+// accepts AVX2 intrinsics in any function, GCC and Clang only when asked.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HAVE_AVX2
+#ifdef _MSC_VER
+#include <immintrin.h>
+#define TARGET_AVX2
+static __inline bool cpu_has_avx2(void)
+{
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // AVX, and the OS saving YMM registers on context switch
+    __cpuid(info, 1);
+    if ((info[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & 0x20) != 0;
+}
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+static __inline bool cpu_has_avx2(void)
+{
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <string.h>
+#include "debug_dir.h"
+#include "error.h"
+
+// Sizes of CodeView headers up to the PDB path
+#define CODEVIEW_RSDS_SIZE 24
+#define CODEVIEW_NB10_SIZE 16
+
+// Start iteration over the debug directory entries. An image without a debug
+// directory yields none.
+void debug_iter_init(debug_iter_t *it, const pe_headers_t *pe)
+{
+    data_directory_t dir;
+    it->pe = pe;
+    it->rva = 0;
+    it->left = 0;
+    if (pe_data_dir(pe, DATA_DIR_DEBUG, &dir)) {
+        it->rva = dir.VirtualAddress;
+        it->left = dir.Size / DEBUG_DIRECTORY_SIZE;
+    }
+}
+
+// Decode the next entry. Returns false after the last one, and also with an
+// error set if the directory is damaged.
+bool debug_next_entry(debug_iter_t *it, debug_directory_t *entry)
+{
+    if (it->left == 0) {
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    const void *data = rva_ptr(pe->image, &pe->sections, it->rva, DEBUG_DIRECTORY_SIZE);
+    if (!data) {
+        it->left = 0;
+        set_error("Debug directory is out of image");
+        return false;
+    }
+    memcpy(entry, data, DEBUG_DIRECTORY_SIZE);
+
+    it->left--;
+    it->rva += DEBUG_DIRECTORY_SIZE;
+    return true;
+}
+
+// Pointer to the data of an entry, NULL if it is not in the file. The file
+// offset is used when present; the RVA serves entries that only have one.
+const uint8_t * debug_payload(const pe_headers_t *pe, const debug_directory_t *entry)
+{
+    if (entry->PointerToRawData) {
+        return image_ptr(pe->image, entry->PointerToRawData, entry->SizeOfData);
+    }
+    if (entry->AddressOfRawData) {
+        return rva_ptr(pe->image, &pe->sections, entry->AddressOfRawData, entry->SizeOfData);
+    }
+    return NULL;
+}
+
+// Decode the PDB identity of a CodeView entry. Fails without an error set if
+// the entry is of another type or format.
+bool read_codeview(const pe_headers_t *pe, const debug_directory_t *entry, codeview_t *cv)
+{
+    if (entry->Type != IMAGE_DEBUG_TYPE_CODEVIEW || entry->SizeOfData < 4) {
+        return false;
+    }
+    const uint8_t *data = debug_payload(pe, entry);
+    if (!data) {
+        set_error("CodeView debug data is out of image");
+        return false;
+    }
+
+    size_t header_size;
+    memcpy(&cv->format, data, 4);
+    if (cv->format == CODEVIEW_RSDS && entry->SizeOfData >= CODEVIEW_RSDS_SIZE) {
+        cv->guid = data + 4;
+        cv->signature = 0;
+        memcpy(&cv->age, data + 20, 4);
+        header_size = CODEVIEW_RSDS_SIZE;
+    } else if (cv->format == CODEVIEW_NB10 && entry->SizeOfData >= CODEVIEW_NB10_SIZE) {
+        cv->guid = NULL;
+        memcpy(&cv->signature, data + 8, 4);
+        memcpy(&cv->age, data + 12, 4);
+        header_size = CODEVIEW_NB10_SIZE;
+    } else {
+        return false;
+    }
+
+    // The path is NUL-terminated, but take the rest of the data if it is not
+    const char *path = (const char *)data + header_size;
+    const char *end = memchr(path, '\0', entry->SizeOfData - header_size);
+    cv->pdb_path.str = path;
+    cv->pdb_path.len = end ? (size_t)(end - path) : entry->SizeOfData - header_size;
+    return true;
+}
+
+// Find the first CodeView entry with a PDB identity
+bool find_codeview(const pe_headers_t *pe, codeview_t *cv)
+{
+    debug_iter_t it;
+    debug_directory_t entry;
+    debug_iter_init(&it, pe);
+    while (debug_next_entry(&it, &entry)) {
+        if (read_codeview(pe, &entry, cv)) {
+            return true;
+        }
+        if (has_error()) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Format the key a symbol server stores the PDB under
+void codeview_key(const codeview_t *cv, char key[CODEVIEW_KEY_SIZE])
+{
+    if (cv->format != CODEVIEW_RSDS) {
+        sprintf_s(key, CODEVIEW_KEY_SIZE, "%08X%X", cv->signature, cv->age);
+        return;
+    }
+
+    // GUID is stored as Data1 (LE32), Data2 (LE16), Data3 (LE16), Data4[8]
+    const uint8_t *g = cv->guid;
+    sprintf_s(key, CODEVIEW_KEY_SIZE, "%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%X",
+        g[3], g[2], g[1], g[0], g[5], g[4], g[7], g[6],
+        g[8], g[9], g[10], g[11], g[12], g[13], g[14], g[15], cv->age);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ *
+ * Debug directory decoder. Only the directory entries and the payload of a
+ * CodeView entry are read, and the PDB identity is returned as views of the
+ * image, so it is cheap enough for every file of a corpus scan.
+ */
+
+#ifndef DEBUG_DIR_H
+#define DEBUG_DIR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define DEBUG_DIRECTORY_SIZE 28
+
+// Debug Directory entry
+typedef struct {
+    uint32_t Characteristics;
+    uint32_t TimeDateStamp;
+    uint16_t MajorVersion;
+    uint16_t MinorVersion;
+    uint32_t Type;
+    uint32_t SizeOfData;
+    uint32_t AddressOfRawData;
+    uint32_t PointerToRawData;
+} debug_directory_t;
+
+#define IMAGE_DEBUG_TYPE_UNKNOWN          0
+#define IMAGE_DEBUG_TYPE_COFF             1
+#define IMAGE_DEBUG_TYPE_CODEVIEW         2
+#define IMAGE_DEBUG_TYPE_FPO              3
+#define IMAGE_DEBUG_TYPE_MISC             4
+#define IMAGE_DEBUG_TYPE_EXCEPTION        5
+#define IMAGE_DEBUG_TYPE_FIXUP            6
+#define IMAGE_DEBUG_TYPE_OMAP_TO_SRC      7
+#define IMAGE_DEBUG_TYPE_OMAP_FROM_SRC    8
+#define IMAGE_DEBUG_TYPE_BORLAND          9
+#define IMAGE_DEBUG_TYPE_RESERVED10       10
+#define IMAGE_DEBUG_TYPE_CLSID            11
+
+#define CODEVIEW_RSDS 0x53445352    // "RSDS", PDB 7.0
+#define CODEVIEW_NB10 0x3031424E    // "NB10", PDB 2.0
+
+// Symbol server key: 32 hex digits of GUID, or 8 of NB10 signature, then age
+#define CODEVIEW_KEY_SIZE 41
+
+// PDB identity from a CodeView debug entry
+typedef struct
+{
+    uint32_t       format;          // CODEVIEW_RSDS or CODEVIEW_NB10
+    const uint8_t *guid;            // 16 bytes of GUID if RSDS
+    uint32_t       signature;       // timestamp if NB10
+    uint32_t       age;
+    image_str_t    pdb_path;
+} codeview_t;
+
+// Position in the debug directory
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            rva;        // next entry
+    size_t              left;       // number of entries left
+} debug_iter_t;
+
+void debug_iter_init(debug_iter_t *it, const pe_headers_t *pe);
+bool debug_next_entry(debug_iter_t *it, debug_directory_t *entry);
+
+const uint8_t * debug_payload(const pe_headers_t *pe, const debug_directory_t *entry);
+bool read_codeview(const pe_headers_t *pe, const debug_directory_t *entry, codeview_t *cv);
+bool find_codeview(const pe_headers_t *pe, codeview_t *cv);
+void codeview_key(const codeview_t *cv, char key[CODEVIEW_KEY_SIZE]);
+
+#endif
@@ -1,10 +1,12 @@
 #include "error.h"
 #include <string.h>
+#include "compat.h"
 
 #define ERROR_MSG_MAX_LEN 4096
 
-static bool is_error = false;
-static char error[ERROR_MSG_MAX_LEN + 1] = "";
+// Error state is per thread, so that images can be decoded concurrently
+static THREAD_LOCAL bool is_error = false;
+static THREAD_LOCAL char error[ERROR_MSG_MAX_LEN + 1] = "";
 
 void set_error(const char *msg)
 {
@@ -0,0 +1,208 @@
+#include <string.h>
+#include "exception_table.h"
+#include "error.h"
+
+#define UNWIND_INFO_HEADER_SIZE 4
+
+// Low 2 bits of ARM64 unwind data: 0 for an .xdata RVA, packed data otherwise
+#define ARM64_UNWIND_FLAG_MASK 0x3
+
+// Unwind info chains longer than this are taken as cycles
+#define MAX_UNWIND_CHAIN 32
+
+static uint32_t _load_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+// Locate the function table. Fails without an error set if the image has no
+// exception directory.
+bool read_exception_table(const pe_headers_t *pe, exception_table_t *table)
+{
+    memset(table, 0, sizeof(exception_table_t));
+    table->pe = pe;
+
+    data_directory_t dir;
+    if (!pe_data_dir(pe, DATA_DIR_EXCEPTION_TABLE, &dir)) {
+        return false;
+    }
+    if (pe->coff.Machine == IMAGE_FILE_MACHINE_AMD64) {
+        table->entry_size = RUNTIME_FUNCTION_SIZE_X64;
+    } else if (pe->coff.Machine == IMAGE_FILE_MACHINE_ARM64) {
+        table->entry_size = RUNTIME_FUNCTION_SIZE_ARM64;
+    } else {
+        set_error("Exception table of this machine type is not supported");
+        return false;
+    }
+
+    table->num = dir.Size / table->entry_size;
+    table->entries = rva_ptr(pe->image, &pe->sections, dir.VirtualAddress, table->num * table->entry_size);
+    if (!table->entries) {
+        set_error("Exception table is out of image");
+        return false;
+    }
+
+    // The loader bisects the table; check once that this is possible
+    table->sorted = true;
+    for (size_t i = 1; i < table->num; i++) {
+        if (_load_u32(table->entries + (i - 1) * table->entry_size) > _load_u32(table->entries + i * table->entry_size)) {
+            table->sorted = false;
+            break;
+        }
+    }
+    return true;
+}
+
+// Decode a function table entry
+bool exception_function_at(const exception_table_t *table, size_t idx, runtime_function_t *func)
+{
+    if (idx >= table->num) {
+        set_error("Function index is out of exception table");
+        return false;
+    }
+
+    const uint8_t *p = table->entries + idx * table->entry_size;
+    func->BeginAddress = _load_u32(p);
+    if (table->entry_size == RUNTIME_FUNCTION_SIZE_X64) {
+        func->EndAddress = _load_u32(p + 4);
+        func->UnwindInfoAddress = _load_u32(p + 8);
+        return true;
+    }
+
+    // ARM64: function length in 4-byte units, packed in bits 2-12, or in
+    // bits 0-17 of the first .xdata word
+    uint32_t unwind = _load_u32(p + 4);
+    uint32_t length;
+    func->UnwindInfoAddress = unwind;
+    if ((unwind & ARM64_UNWIND_FLAG_MASK) == 0) {
+        const pe_headers_t *pe = table->pe;
+        const uint8_t *xdata = rva_ptr(pe->image, &pe->sections, unwind, 4);
+        if (!xdata) {
+            set_error("Unwind data is out of image");
+            return false;
+        }
+        length = _load_u32(xdata) & 0x3FFFF;
+    } else {
+        length = (unwind >> 2) & 0x7FF;
+    }
+    func->EndAddress = func->BeginAddress + 4 * length;
+    return true;
+}
+
+// Find the function containing an RVA. Fails without an error set if no
+// function contains it.
+bool exception_find_function(const exception_table_t *table, uint32_t rva, runtime_function_t *func)
+{
+    size_t n = table->num;
+    if (n == 0) {
+        return false;
+    }
+
+    if (!table->sorted) {
+        for (size_t i = 0; i < n; i++) {
+            if (_load_u32(table->entries + i * table->entry_size) <= rva) {
+                if (!exception_function_at(table, i, func)) {
+                    return false;
+                }
+                if (rva < func->EndAddress) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Last entry starting at or before rva
+    const uint8_t *base = table->entries;
+    size_t entry_size = table->entry_size;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = (_load_u32(base + half * entry_size) <= rva) ? base + half * entry_size : base;
+        n -= half;
+    }
+    if (_load_u32(base) > rva) {
+        return false;
+    }
+    size_t idx = (size_t)(base - table->entries) / entry_size;
+    return exception_function_at(table, idx, func) && rva < func->EndAddress;
+}
+
+// Decode the x64 unwind info of a function
+bool read_unwind_info(const exception_table_t *table, const runtime_function_t *func, unwind_info_t *info)
+{
+    if (table->entry_size != RUNTIME_FUNCTION_SIZE_X64) {
+        set_error("Unwind info is only decoded for x64");
+        return false;
+    }
+
+    const pe_headers_t *pe = table->pe;
+    uint32_t rva = func->UnwindInfoAddress;
+
+    // An odd address points to another function table entry that shares
+    // its unwind info
+    if (rva & 1) {
+        const uint8_t *entry = rva_ptr(pe->image, &pe->sections, rva & ~1u, RUNTIME_FUNCTION_SIZE_X64);
+        if (!entry) {
+            set_error("Unwind info is out of image");
+            return false;
+        }
+        rva = _load_u32(entry + 8);
+    }
+
+    const uint8_t *header = rva_ptr(pe->image, &pe->sections, rva, UNWIND_INFO_HEADER_SIZE);
+    if (!header) {
+        set_error("Unwind info is out of image");
+        return false;
+    }
+    info->version = header[0] & 0x7;
+    info->flags = header[0] >> 3;
+    info->prolog_size = header[1];
+    info->code_num = header[2];
+    info->frame_register = header[3] & 0xF;
+    info->frame_offset = header[3] >> 4;
+
+    // Codes are padded to an even number, then comes the handler or the
+    // chained function
+    size_t codes_size = 2 * (((size_t)info->code_num + 1) & ~(size_t)1);
+    size_t tail_size = (info->flags & UNW_FLAG_CHAININFO) ? RUNTIME_FUNCTION_SIZE_X64 :
+        (info->flags & (UNW_FLAG_EHANDLER | UNW_FLAG_UHANDLER)) ? 4 : 0;
+    const uint8_t *data = rva_ptr(pe->image, &pe->sections, rva, UNWIND_INFO_HEADER_SIZE + codes_size + tail_size);
+    if (!data) {
+        set_error("Unwind info is out of image");
+        return false;
+    }
+    info->codes = data + UNWIND_INFO_HEADER_SIZE;
+
+    const uint8_t *tail = info->codes + codes_size;
+    info->handler_rva = 0;
+    memset(&info->chained, 0, sizeof(runtime_function_t));
+    if (info->flags & UNW_FLAG_CHAININFO) {
+        info->chained.BeginAddress = _load_u32(tail);
+        info->chained.EndAddress = _load_u32(tail + 4);
+        info->chained.UnwindInfoAddress = _load_u32(tail + 8);
+    } else if (tail_size) {
+        info->handler_rva = _load_u32(tail);
+    }
+    return true;
+}
+
+// Follow chained unwind info from a function fragment to the function it
+// belongs to
+bool exception_primary_function(const exception_table_t *table, const runtime_function_t *func, runtime_function_t *primary)
+{
+    *primary = *func;
+    for (size_t i = 0; i < MAX_UNWIND_CHAIN; i++) {
+        unwind_info_t info;
+        if (!read_unwind_info(table, primary, &info)) {
+            return false;
+        }
+        if (!(info.flags & UNW_FLAG_CHAININFO)) {
+            return true;
+        }
+        *primary = info.chained;
+    }
+    set_error("Unwind info chain is too long");
+    return false;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file
+ *
+ * Exception directory (.pdata) decoder. The function table is used in place
+ * as a span of entries sorted by start address, so finding the function that
+ * contains an RVA is a binary search. Unwind information is decoded only for
+ * the functions that are looked up.
+ */
+
+#ifndef EXCEPTION_TABLE_H
+#define EXCEPTION_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define RUNTIME_FUNCTION_SIZE_X64   12
+#define RUNTIME_FUNCTION_SIZE_ARM64 8
+
+// Unwind info flags (x64)
+#define UNW_FLAG_EHANDLER  0x1
+#define UNW_FLAG_UHANDLER  0x2
+#define UNW_FLAG_CHAININFO 0x4
+
+// Function table entry. On ARM64 the end address is derived from the
+// function length in the packed unwind data or in the .xdata header.
+typedef struct {
+    uint32_t BeginAddress;
+    uint32_t EndAddress;
+    uint32_t UnwindInfoAddress;     // RVA of unwind info, or packed unwind data on ARM64
+} runtime_function_t;
+
+// Function table of an image
+typedef struct
+{
+    const pe_headers_t *pe;
+    const uint8_t      *entries;    // num unaligned entries of entry_size bytes
+    size_t              num;
+    size_t              entry_size;
+    bool                sorted;     // entries are sorted, so lookup can bisect
+} exception_table_t;
+
+// x64 UNWIND_INFO
+typedef struct
+{
+    uint8_t            version;
+    uint8_t            flags;       // UNW_FLAG_*
+    uint8_t            prolog_size;
+    uint8_t            code_num;    // number of 2-byte unwind codes
+    uint8_t            frame_register;
+    uint8_t            frame_offset;
+    const uint8_t     *codes;
+    uint32_t           handler_rva; // if EHANDLER or UHANDLER
+    runtime_function_t chained;     // if CHAININFO
+} unwind_info_t;
+
+bool read_exception_table(const pe_headers_t *pe, exception_table_t *table);
+
+bool exception_function_at(const exception_table_t *table, size_t idx, runtime_function_t *func);
+bool exception_find_function(const exception_table_t *table, uint32_t rva, runtime_function_t *func);
+bool read_unwind_info(const exception_table_t *table, const runtime_function_t *func, unwind_info_t *info);
+bool exception_primary_function(const exception_table_t *table, const runtime_function_t *func, runtime_function_t *primary);
+
+#endif
@@ -0,0 +1,174 @@
+#include <string.h>
+#include "export_table.h"
+#include "error.h"
+
+static uint32_t _load_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static uint16_t _load_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Get name of the idx-th entry of the name pointer table
+static bool _name(const export_table_t *table, uint32_t idx, image_str_t *name)
+{
+    const pe_headers_t *pe = table->pe;
+    name->str = rva_str(pe->image, &pe->sections, _load_u32(table->names + 4 * (size_t)idx), &name->len);
+    if (!name->str) {
+        set_error("Exported name is out of image");
+        return false;
+    }
+    return true;
+}
+
+// Compare like strcmp, by unsigned bytes
+static int _cmp_name(image_str_t a, const char *b, size_t b_len)
+{
+    size_t len = (a.len < b_len) ? a.len : b_len;
+    int r = memcmp(a.str, b, len);
+    if (r != 0) {
+        return r;
+    }
+    return (a.len > b_len) - (a.len < b_len);
+}
+
+// Locate the export tables. Fails without an error set if the image has no
+// export directory.
+bool read_export_table(const pe_headers_t *pe, export_table_t *table)
+{
+    memset(table, 0, sizeof(export_table_t));
+    table->pe = pe;
+
+    data_directory_t dd;
+    if (!pe_data_dir(pe, DATA_DIR_EXPORT_TABLE, &dd)) {
+        return false;
+    }
+    table->dir_start = dd.VirtualAddress;
+    table->dir_end = (dd.Size <= UINT32_MAX - dd.VirtualAddress) ? dd.VirtualAddress + dd.Size : UINT32_MAX;
+
+    const void *data = rva_ptr(pe->image, &pe->sections, dd.VirtualAddress, EXPORT_DIRECTORY_SIZE);
+    if (!data) {
+        set_error("Export directory table is out of image");
+        return false;
+    }
+    memcpy(&table->dir, data, EXPORT_DIRECTORY_SIZE);
+    const export_directory_t *dir = &table->dir;
+
+    // The name is informational, a damaged one is left empty
+    table->name.str = rva_str(pe->image, &pe->sections, dir->Name, &table->name.len);
+    if (!table->name.str) {
+        table->name.str = "";
+        table->name.len = 0;
+    }
+
+    table->functions = rva_ptr(pe->image, &pe->sections, dir->AddressOfFunctions, 4 * (size_t)dir->NumberOfFunctions);
+    table->names = rva_ptr(pe->image, &pe->sections, dir->AddressOfNames, 4 * (size_t)dir->NumberOfNames);
+    table->ordinals = rva_ptr(pe->image, &pe->sections, dir->AddressOfNameOrdinals, 2 * (size_t)dir->NumberOfNames);
+    if ((dir->NumberOfFunctions && !table->functions) || (dir->NumberOfNames && (!table->names || !table->ordinals))) {
+        set_error("Export tables are out of image");
+        return false;
+    }
+
+    // The loader bisects the names as well, but a damaged image may not keep
+    // them sorted. Check once so every later lookup can rely on it.
+    table->sorted = true;
+    image_str_t prev, cur;
+    for (uint32_t i = 0; i < dir->NumberOfNames; i++) {
+        if (!_name(table, i, &cur)) {
+            return false;
+        }
+        if (i > 0 && _cmp_name(prev, cur.str, cur.len) > 0) {
+            table->sorted = false;
+            break;
+        }
+        prev = cur;
+    }
+    return true;
+}
+
+// Decode the export address table entry at an index
+static bool _export_at(const export_table_t *table, uint32_t idx, export_t *exp)
+{
+    if (idx >= table->dir.NumberOfFunctions) {
+        set_error("Export ordinal is out of the export address table");
+        return false;
+    }
+
+    const pe_headers_t *pe = table->pe;
+    exp->ordinal = table->dir.Base + idx;
+    exp->rva = _load_u32(table->functions + 4 * (size_t)idx);
+    exp->forwarded = (exp->rva >= table->dir_start && exp->rva < table->dir_end);
+    exp->forwarder.str = NULL;
+    exp->forwarder.len = 0;
+    if (exp->forwarded) {
+        exp->forwarder.str = rva_str(pe->image, &pe->sections, exp->rva, &exp->forwarder.len);
+        if (!exp->forwarder.str) {
+            set_error("Export forwarder is out of image");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Find an export by ordinal. Fails without an error set if there is none.
+bool export_by_ordinal(const export_table_t *table, uint32_t ordinal, export_t *exp)
+{
+    uint32_t idx = ordinal - table->dir.Base;
+    if (ordinal < table->dir.Base || idx >= table->dir.NumberOfFunctions) {
+        return false;
+    }
+    return _export_at(table, idx, exp);
+}
+
+// Find an export by name. Fails without an error set if there is none.
+bool export_by_name(const export_table_t *table, const char *name, export_t *exp)
+{
+    size_t name_len = strlen(name);
+    uint32_t lo = 0;
+    uint32_t hi = table->dir.NumberOfNames;
+    image_str_t cur;
+
+    if (table->sorted) {
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (!_name(table, mid, &cur)) {
+                return false;
+            }
+            int r = _cmp_name(cur, name, name_len);
+            if (r == 0) {
+                return _export_at(table, _load_u16(table->ordinals + 2 * (size_t)mid), exp);
+            }
+            if (r < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return false;
+    }
+
+    for (uint32_t i = 0; i < hi; i++) {
+        if (!_name(table, i, &cur)) {
+            return false;
+        }
+        if (_cmp_name(cur, name, name_len) == 0) {
+            return _export_at(table, _load_u16(table->ordinals + 2 * (size_t)i), exp);
+        }
+    }
+    return false;
+}
+
+// Get the idx-th exported name in name pointer table order with its export
+bool export_name_at(const export_table_t *table, uint32_t idx, image_str_t *name, export_t *exp)
+{
+    if (idx >= table->dir.NumberOfNames) {
+        set_error("Export name index is out of the name pointer table");
+        return false;
+    }
+    return _name(table, idx, name) && _export_at(table, _load_u16(table->ordinals + 2 * (size_t)idx), exp);
+}
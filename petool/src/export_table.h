@@ -0,0 +1,65 @@
+/**
+ * @file
+ *
+ * Export directory decoder. The tables are located once per image and then
+ * used in place: the export address table is the ordinal index, and the name
+ * pointer table, which the format requires to be sorted, is searched by
+ * bisection without copying or allocating.
+ */
+
+#ifndef EXPORT_TABLE_H
+#define EXPORT_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define EXPORT_DIRECTORY_SIZE 40
+
+// Export Directory Table
+typedef struct {
+    uint32_t Characteristics;
+    uint32_t TimeDateStamp;
+    uint16_t MajorVersion;
+    uint16_t MinorVersion;
+    uint32_t Name;                  // RVA of the DLL name
+    uint32_t Base;                  // ordinal of the first export address table entry
+    uint32_t NumberOfFunctions;
+    uint32_t NumberOfNames;
+    uint32_t AddressOfFunctions;    // RVA of the export address table
+    uint32_t AddressOfNames;        // RVA of the name pointer table
+    uint32_t AddressOfNameOrdinals; // RVA of the ordinal table
+} export_directory_t;
+
+// Located export tables of an image
+typedef struct
+{
+    const pe_headers_t *pe;
+    export_directory_t  dir;
+    image_str_t         name;       // DLL name
+    uint32_t            dir_start;  // RVA range of the export data directory,
+    uint32_t            dir_end;    //     which contains forwarder strings
+    const uint8_t      *functions;  // export address table, NumberOfFunctions entries
+    const uint8_t      *names;      // name pointer table, NumberOfNames entries
+    const uint8_t      *ordinals;   // ordinal table, NumberOfNames entries
+    bool                sorted;     // names are sorted, so lookup can bisect
+} export_table_t;
+
+// Exported symbol
+typedef struct
+{
+    uint32_t    ordinal;
+    uint32_t    rva;                // address, or RVA of forwarder if forwarded
+    bool        forwarded;
+    image_str_t forwarder;          // "DLL.Name" or "DLL.#ordinal" if forwarded
+} export_t;
+
+bool read_export_table(const pe_headers_t *pe, export_table_t *table);
+
+bool export_by_ordinal(const export_table_t *table, uint32_t ordinal, export_t *exp);
+bool export_by_name(const export_table_t *table, const char *name, export_t *exp);
+bool export_name_at(const export_table_t *table, uint32_t idx, image_str_t *name, export_t *exp);
+
+#endif
@@ -34,7 +34,7 @@ static const SDL_Color popup_border_color   = { 0xFF, 0x99, 0x33, 0xFF };
 
 typedef struct
 {
-    vis_struct_t *vis;
+    const vis_instance_t *inst;
     int x, y;
 } gfx_struct_t;
 
@@ -144,19 +144,21 @@ void _render_popup(int x, int y, const char *text)
     
 }
 
-void _render_vis_struct(vis_struct_t *st, int x, int y)
+void _render_vis_struct(const vis_instance_t *inst, int x, int y)
 {
+    const vis_struct_t *st = inst->st;
+    char value_str[MAX_VALUE_STR_LEN + 1];
     SDL_Rect name_rect = { x, y, NAME_WIDTH, CELL_HEIGHT };
     SDL_Rect value_rect = { x + NAME_WIDTH - 1, y, VALUE_WIDTH, CELL_HEIGHT };
     for (int i = 0; i < st->fields.size; i++) {
-        vis_field_t *field = store_pget(&st->fields, i);
+        const vis_field_t *field = store_pget(&st->fields, i);
 
         _set_color(grid_color);
         SDL_RenderDrawRect(renderer, &name_rect);
         SDL_RenderDrawRect(renderer, &value_rect);
 
-        _render_text(field->name, name_rect.x + 1, name_rect.y);
-        _render_text(vis_field_value_str(field), value_rect.x + 1, value_rect.y);
+        _render_text(vis_str(field->name), name_rect.x + 1, name_rect.y);
+        _render_text(vis_field_value_str(field, vis_instance_value(inst, field), value_str, sizeof(value_str)), value_rect.x + 1, value_rect.y);
 
         name_rect.y += CELL_HEIGHT - 1;
         value_rect.y += CELL_HEIGHT - 1;
@@ -172,7 +174,7 @@ void gfx_render()
     // Draw visual structures
     for (size_t i = 0; i < gfx_structs.size; i++) {
         gfx_struct_t *gs = store_pget(&gfx_structs, i);
-        _render_vis_struct(gs->vis, gs->x, gs->y);
+        _render_vis_struct(gs->inst, gs->x, gs->y);
     }
 
     // Draw popup help, if cursor is in position
@@ -182,10 +184,10 @@ void gfx_render()
     for (size_t i = 0; i < gfx_structs.size; i++) {
         gfx_struct_t *gs = store_pget(&gfx_structs, i);
         if (mouse_x >= gs->x && mouse_x < gs->x + NAME_WIDTH + VALUE_WIDTH &&
-                mouse_y >= gs->y && mouse_y < gs->y + CELL_HEIGHT * gs->vis->fields.size) {
+                mouse_y >= gs->y && mouse_y < gs->y + CELL_HEIGHT * gs->inst->st->fields.size) {
             size_t field_idx = (mouse_y - gs->y) / CELL_HEIGHT;
-            vis_field_t *field = store_pget(&gs->vis->fields, field_idx);
-            _render_popup(mouse_x + POPUP_MOUSE_OFFSET, mouse_y + POPUP_MOUSE_OFFSET, field->description);
+            const vis_field_t *field = store_pget(&gs->inst->st->fields, field_idx);
+            _render_popup(mouse_x + POPUP_MOUSE_OFFSET, mouse_y + POPUP_MOUSE_OFFSET, vis_str(field->description));
             break;
         }
     }
@@ -196,11 +198,10 @@ void gfx_render()
     SDL_RenderPresent(renderer);
 }
 
-void gfx_loop()
+void gfx_loop(const vis_instance_t *inst)
 {
-    vis_struct_t *coff_file_header = vis_find_struct("COFF File Header");
     gfx_struct_t *gs = store_alloc(&gfx_structs);
-    gs->vis = coff_file_header;
+    gs->inst = inst;
     gs->x = 80;
     gs->y = 50;
 
@@ -1,9 +1,11 @@
 #ifndef GFX_H
 #define GFX_H
 
+#include "vis_struct.h"
+
 void gfx_init();
 void gfx_kill();
 
-void gfx_loop();
+void gfx_loop(const vis_instance_t *inst);
 
 #endif
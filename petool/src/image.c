@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include "image.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define READ_CHUNK_SIZE 65536
+
+static const pe_image_t empty_image = { .data = NULL, .size = 0, .mapped = false, .mapping = NULL };
+
+// Wrap a file that cannot be mapped in a stream, so that it is read without
+// opening the path again. Takes ownership of the file; NULL on failure.
+#ifdef _WIN32
+static FILE * _file_stream(HANDLE file)
+{
+    int fd = _open_osfhandle((intptr_t)file, _O_RDONLY);
+    if (fd < 0) {
+        CloseHandle(file);
+        return NULL;
+    }
+    FILE *stream = _fdopen(fd, "rb");
+    if (!stream) {
+        _close(fd);
+    }
+    return stream;
+}
+#else
+static FILE * _file_stream(int fd)
+{
+    FILE *stream = fdopen(fd, "rb");
+    if (!stream) {
+        close(fd);
+    }
+    return stream;
+}
+#endif
+
+// Try to map a regular file into memory. If the file is opened but cannot be
+// mapped (pipes, empty files), returns false with *stream set for reading it
+// instead; *stream stays NULL if the file cannot be opened at all.
+static bool _map_file(pe_image_t *image, const char *fname, FILE **stream)
+{
+    *stream = NULL;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || size.QuadPart == 0 ||
+            (uint64_t)size.QuadPart > SIZE_MAX) {
+        *stream = _file_stream(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        *stream = _file_stream(file);
+        return false;
+    }
+
+    const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        *stream = _file_stream(file);
+        return false;
+    }
+    CloseHandle(file);
+
+    image->data = view;
+    image->size = (size_t)size.QuadPart;
+    image->mapped = true;
+    image->mapping = mapping;
+    return true;
+#else
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        *stream = _file_stream(fd);
+        return false;
+    }
+
+    void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        *stream = _file_stream(fd);
+        return false;
+    }
+    close(fd);
+
+    image->data = view;
+    image->size = (size_t)st.st_size;
+    image->mapped = true;
+    image->mapping = NULL;
+    return true;
+#endif
+}
+
+// Open image file, mapping it into memory if possible
+bool image_open(pe_image_t *image, const char *fname)
+{
+    *image = empty_image;
+
+    FILE *infile = NULL;
+    if (_map_file(image, fname, &infile)) {
+        return true;
+    }
+    if (!infile) {
+        set_error("Failed to open image file");
+        return false;
+    }
+    bool ok = image_open_stream(image, infile);
+    fclose(infile);
+    return ok;
+}
+
+// Read the whole stream into a buffer. Used for streams that cannot be mapped.
+bool image_open_stream(pe_image_t *image, FILE *stream)
+{
+    *image = empty_image;
+
+    uint8_t *buffer = NULL;
+    size_t cap = 0;
+    size_t size = 0;
+    for (;;) {
+        if (size + READ_CHUNK_SIZE > cap) {
+            cap = cap * 2 + READ_CHUNK_SIZE;
+            uint8_t *grown = realloc(buffer, cap);
+            if (!grown) {
+                free(buffer);
+                set_error("Not enough memory to read image");
+                return false;
+            }
+            buffer = grown;
+        }
+
+        size_t got = fread(buffer + size, 1, READ_CHUNK_SIZE, stream);
+        size += got;
+        if (got < READ_CHUNK_SIZE) {
+            break;
+        }
+    }
+
+    if (ferror(stream)) {
+        free(buffer);
+        set_error("Failed to read image");
+        return false;
+    }
+
+    image->data = buffer;
+    image->size = size;
+    return true;
+}
+
+// Release image contents
+void image_close(pe_image_t *image)
+{
+    if (image->mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(image->data);
+        CloseHandle(image->mapping);
+#else
+        munmap((void *)image->data, image->size);
+#endif
+    } else {
+        free((void *)image->data);
+    }
+    *image = empty_image;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file
+ *
+ * Read-only in-memory view of an image file. The file is mapped into memory
+ * when possible, or read into a buffer otherwise (pipes, empty files). All
+ * decoders read from the image by file offset, so reading a field is a bounds
+ * check and a plain load.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "error.h"
+
+typedef struct pe_image_t
+{
+    const uint8_t *data;        // image contents
+    size_t         size;        // image size in bytes
+    bool           mapped;      // data is a file mapping, not a heap buffer
+    void          *mapping;     // platform handle of the mapping
+} pe_image_t;
+
+// String inside the image, not NUL-terminated when it fills its whole field
+typedef struct image_str_t
+{
+    const char *str;
+    size_t      len;
+} image_str_t;
+
+bool image_open(pe_image_t *image, const char *fname);
+bool image_open_stream(pe_image_t *image, FILE *stream);
+void image_close(pe_image_t *image);
+
+// Check if [offset, offset + size) lies within the image
+static __inline bool image_has(const pe_image_t *image, size_t offset, size_t size)
+{
+    return (offset <= image->size && size <= image->size - offset);
+}
+
+// Get pointer to size bytes at offset, or NULL if they are out of the image
+static __inline const void * image_ptr(const pe_image_t *image, size_t offset, size_t size)
+{
+    if (!image_has(image, offset, size)) {
+        return NULL;
+    }
+    return image->data + offset;
+}
+
+static __inline bool image_read_u8(const pe_image_t *image, size_t offset, uint8_t *value)
+{
+    if (!image_has(image, offset, 1)) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    *value = image->data[offset];
+    return true;
+}
+
+static __inline bool image_read_u16(const pe_image_t *image, size_t offset, uint16_t *value)
+{
+    if (!image_has(image, offset, 2)) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(value, image->data + offset, 2);
+    return true;
+}
+
+static __inline bool image_read_u32(const pe_image_t *image, size_t offset, uint32_t *value)
+{
+    if (!image_has(image, offset, 4)) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(value, image->data + offset, 4);
+    return true;
+}
+
+static __inline bool image_read_u64(const pe_image_t *image, size_t offset, uint64_t *value)
+{
+    if (!image_has(image, offset, 8)) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(value, image->data + offset, 8);
+    return true;
+}
+
+// Copy size bytes at offset into a structure
+static __inline bool image_read(const pe_image_t *image, size_t offset, void *dest, size_t size)
+{
+    if (!image_has(image, offset, size)) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(dest, image->data + offset, size);
+    return true;
+}
+
+#endif
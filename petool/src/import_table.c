@@ -0,0 +1,345 @@
+#include <stdlib.h>
+#include <string.h>
+#include "import_table.h"
+#include "error.h"
+
+#define ORDINAL_FLAG_PE32      0x80000000ull
+#define ORDINAL_FLAG_PE32_PLUS 0x8000000000000000ull
+#define HINT_NAME_RVA_MASK     0x7FFFFFFFull
+
+// Start iteration over the imported DLLs. An image without an import
+// directory yields none.
+void import_iter_init(import_iter_t *it, const pe_headers_t *pe)
+{
+    data_directory_t dir;
+    it->pe = pe;
+    it->rva = pe_data_dir(pe, DATA_DIR_IMPORT_TABLE, &dir) ? dir.VirtualAddress : 0;
+}
+
+// Decode the next descriptor and its DLL name. Returns false after the last
+// one, and also with an error set if the table is damaged.
+bool import_next_dll(import_iter_t *it, import_dll_t *dll)
+{
+    if (it->rva == 0) {
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    const void *data = rva_ptr(pe->image, &pe->sections, it->rva, IMPORT_DESCRIPTOR_SIZE);
+    if (!data) {
+        it->rva = 0;
+        set_error("Import directory table is out of image");
+        return false;
+    }
+    memcpy(&dll->desc, data, IMPORT_DESCRIPTOR_SIZE);
+
+    // Like the loader, stop at the first descriptor without a name or IAT
+    // rather than at the size given by the data directory
+    if (dll->desc.Name == 0 || dll->desc.FirstThunk == 0) {
+        it->rva = 0;
+        return false;
+    }
+
+    dll->name.str = rva_str(pe->image, &pe->sections, dll->desc.Name, &dll->name.len);
+    if (!dll->name.str) {
+        it->rva = 0;
+        set_error("Imported DLL name is out of image");
+        return false;
+    }
+
+    it->rva = (it->rva <= UINT32_MAX - IMPORT_DESCRIPTOR_SIZE) ? it->rva + IMPORT_DESCRIPTOR_SIZE : 0;
+    return true;
+}
+
+// Start iteration over the functions imported from a DLL. Images without
+// an import lookup table keep the names in the IAT.
+void import_func_iter_init(import_func_iter_t *it, const pe_headers_t *pe, const import_dll_t *dll)
+{
+    it->pe = pe;
+    it->lookup_rva = dll->desc.OriginalFirstThunk ? dll->desc.OriginalFirstThunk : dll->desc.FirstThunk;
+    it->iat_rva = dll->desc.FirstThunk;
+    it->va_based = false;
+}
+
+// Decode the next lookup table entry. Returns false after the last one, and
+// also with an error set if the table is damaged.
+bool import_next_func(import_func_iter_t *it, import_func_t *func)
+{
+    if (it->lookup_rva == 0) {
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    size_t thunk_size = pe_addr_size(pe);
+    const uint8_t *data = rva_ptr(pe->image, &pe->sections, it->lookup_rva, thunk_size);
+    if (!data) {
+        it->lookup_rva = 0;
+        set_error("Import lookup table is out of image");
+        return false;
+    }
+
+    uint64_t ordinal_flag;
+    if (thunk_size == 8) {
+        memcpy(&func->value, data, 8);
+        ordinal_flag = ORDINAL_FLAG_PE32_PLUS;
+    } else {
+        uint32_t value;
+        memcpy(&value, data, 4);
+        func->value = value;
+        ordinal_flag = ORDINAL_FLAG_PE32;
+    }
+    if (func->value == 0) {
+        it->lookup_rva = 0;
+        return false;
+    }
+
+    func->iat_rva = it->iat_rva;
+    func->by_ordinal = (func->value & ordinal_flag) != 0;
+    if (func->by_ordinal) {
+        func->ordinal = (uint16_t)func->value;
+        func->hint = 0;
+        func->name.str = NULL;
+        func->name.len = 0;
+    } else {
+        // Hint/Name Table entry: 2-byte hint followed by the name
+        uint32_t hint_rva = (uint32_t)(func->value & HINT_NAME_RVA_MASK);
+        const uint8_t *hint = NULL;
+        if (!it->va_based || pe_va_to_rva(pe, func->value, &hint_rva)) {
+            hint = rva_ptr(pe->image, &pe->sections, hint_rva, 2);
+        }
+        func->name.str = hint ? rva_str(pe->image, &pe->sections, hint_rva + 2, &func->name.len) : NULL;
+        if (!func->name.str) {
+            it->lookup_rva = 0;
+            set_error("Imported function name is out of image");
+            return false;
+        }
+        func->ordinal = 0;
+        func->hint = (uint16_t)(hint[0] | (hint[1] << 8));
+    }
+
+    if (it->lookup_rva > UINT32_MAX - thunk_size) {
+        it->lookup_rva = 0;
+    } else {
+        it->lookup_rva += (uint32_t)thunk_size;
+        it->iat_rva += (uint32_t)thunk_size;
+    }
+    return true;
+}
+
+// Start iteration over the delay-loaded DLLs. An image without a delay-load
+// directory yields none.
+void delay_import_iter_init(import_iter_t *it, const pe_headers_t *pe)
+{
+    data_directory_t dir;
+    it->pe = pe;
+    it->rva = pe_data_dir(pe, DATA_DIR_DELAY_IMPORT_DESCRIPTOR, &dir) ? dir.VirtualAddress : 0;
+}
+
+// Convert an address of a VA-based descriptor, keeping 0 for absent tables
+static bool _delay_va_to_rva(const pe_headers_t *pe, uint32_t *addr)
+{
+    return (*addr == 0 || pe_va_to_rva(pe, *addr, addr));
+}
+
+// Decode the next delay-load descriptor and its DLL name. Returns false after
+// the last one, and also with an error set if the table is damaged.
+bool delay_import_next_dll(import_iter_t *it, delay_import_dll_t *dll)
+{
+    if (it->rva == 0) {
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    const void *data = rva_ptr(pe->image, &pe->sections, it->rva, DELAY_IMPORT_DESCRIPTOR_SIZE);
+    if (!data) {
+        it->rva = 0;
+        set_error("Delay-load directory table is out of image");
+        return false;
+    }
+    memcpy(&dll->desc, data, DELAY_IMPORT_DESCRIPTOR_SIZE);
+    if (dll->desc.Name == 0) {
+        it->rva = 0;
+        return false;
+    }
+
+    // Descriptors of old linkers hold VAs, which fit in 32 bits only in PE32
+    delay_import_descriptor_t *desc = &dll->desc;
+    if (!(desc->Attributes & DELAY_IMPORT_RVA_BASED) &&
+            !(_delay_va_to_rva(pe, &desc->Name) && _delay_va_to_rva(pe, &desc->ModuleHandle) &&
+            _delay_va_to_rva(pe, &desc->DelayImportAddressTable) && _delay_va_to_rva(pe, &desc->DelayImportNameTable) &&
+            _delay_va_to_rva(pe, &desc->BoundDelayImportTable) && _delay_va_to_rva(pe, &desc->UnloadDelayImportTable))) {
+        it->rva = 0;
+        set_error("Delay-load descriptor is out of image");
+        return false;
+    }
+
+    dll->name.str = rva_str(pe->image, &pe->sections, desc->Name, &dll->name.len);
+    if (!dll->name.str) {
+        it->rva = 0;
+        set_error("Delay-loaded DLL name is out of image");
+        return false;
+    }
+
+    it->rva = (it->rva <= UINT32_MAX - DELAY_IMPORT_DESCRIPTOR_SIZE) ? it->rva + DELAY_IMPORT_DESCRIPTOR_SIZE : 0;
+    return true;
+}
+
+// Start iteration over the functions delay-loaded from a DLL. The lookup
+// table entries are walked like those of normal imports.
+void delay_import_func_iter_init(import_func_iter_t *it, const pe_headers_t *pe, const delay_import_dll_t *dll)
+{
+    it->pe = pe;
+    it->lookup_rva = dll->desc.DelayImportNameTable;
+    it->iat_rva = dll->desc.DelayImportAddressTable;
+    it->va_based = !(dll->desc.Attributes & DELAY_IMPORT_RVA_BASED);
+}
+
+// Start iteration over the bound import directory. An image without one
+// yields none.
+void bound_import_iter_init(bound_import_iter_t *it, const pe_headers_t *pe)
+{
+    data_directory_t dir;
+    it->pe = pe;
+    it->base = 0;
+    it->rva = 0;
+    it->end = 0;
+    it->forwarder_num = 0;
+    if (pe_data_dir(pe, DATA_DIR_BOUND_IMPORT, &dir) && dir.Size <= UINT32_MAX - dir.VirtualAddress) {
+        it->base = dir.VirtualAddress;
+        it->rva = dir.VirtualAddress;
+        it->end = dir.VirtualAddress + dir.Size;
+    }
+}
+
+// Decode the next module or forwarder entry. Returns false after the last
+// one, and also with an error set if the directory is damaged.
+bool bound_import_next(bound_import_iter_t *it, bound_import_t *bound)
+{
+    if (it->end == 0) {
+        return false;
+    }
+    if (it->end - it->rva < BOUND_IMPORT_DESCRIPTOR_SIZE) {
+        it->end = 0;
+        set_error("Bound import directory is truncated");
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    const void *data = rva_ptr(pe->image, &pe->sections, it->rva, BOUND_IMPORT_DESCRIPTOR_SIZE);
+    if (!data) {
+        it->end = 0;
+        set_error("Bound import directory is out of image");
+        return false;
+    }
+    memcpy(&bound->desc, data, BOUND_IMPORT_DESCRIPTOR_SIZE);
+
+    bound->forwarder = (it->forwarder_num > 0);
+    if (bound->forwarder) {
+        it->forwarder_num--;
+    } else if (bound->desc.TimeDateStamp == 0 && bound->desc.OffsetModuleName == 0) {
+        it->end = 0;
+        return false;
+    } else {
+        it->forwarder_num = bound->desc.NumberOfModuleForwarderRefs;
+    }
+
+    bound->name.str = rva_str(pe->image, &pe->sections, it->base + bound->desc.OffsetModuleName, &bound->name.len);
+    if (!bound->name.str) {
+        it->end = 0;
+        set_error("Bound DLL name is out of image");
+        return false;
+    }
+
+    it->rva += BOUND_IMPORT_DESCRIPTOR_SIZE;
+    return true;
+}
+
+// Compare an image string with a C string, ignoring ASCII case
+static bool _str_ieq(image_str_t a, const char *b)
+{
+    size_t i;
+    for (i = 0; i < a.len && b[i]; i++) {
+        char ca = a.str[i];
+        char cb = b[i];
+        if (ca >= 'A' && ca <= 'Z') {
+            ca += 'a' - 'A';
+        }
+        if (cb >= 'A' && cb <= 'Z') {
+            cb += 'a' - 'A';
+        }
+        if (ca != cb) {
+            return false;
+        }
+    }
+    return (i == a.len && b[i] == '\0');
+}
+
+static bool _func_matches(const import_func_t *func, const char *func_name)
+{
+    if (func_name[0] == '#') {
+        return func->by_ordinal && func->ordinal == (uint16_t)strtoul(func_name + 1, NULL, 10);
+    }
+    return !func->by_ordinal && func->name.len == strlen(func_name) &&
+        memcmp(func->name.str, func_name, func->name.len) == 0;
+}
+
+static bool _find_func(import_func_iter_t *funcs, const char *func_name)
+{
+    import_func_t func;
+    while (import_next_func(funcs, &func)) {
+        if (_func_matches(&func, func_name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Check if the image imports a function from a DLL. DLL names are compared
+// ignoring case, function names exactly; "#n" matches import by ordinal n and
+// a NULL func_name matches any function. Stops at the first match, and
+// thunks of other DLLs are never read.
+bool import_find(const pe_headers_t *pe, const char *dll_name, const char *func_name)
+{
+    import_iter_t dlls;
+    import_dll_t dll;
+    import_iter_init(&dlls, pe);
+    while (import_next_dll(&dlls, &dll)) {
+        if (!_str_ieq(dll.name, dll_name)) {
+            continue;
+        }
+        if (!func_name) {
+            return true;
+        }
+
+        import_func_iter_t funcs;
+        import_func_iter_init(&funcs, pe, &dll);
+        if (_find_func(&funcs, func_name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Check if the image delay-loads a function from a DLL, matching names like
+// import_find
+bool delay_import_find(const pe_headers_t *pe, const char *dll_name, const char *func_name)
+{
+    import_iter_t dlls;
+    delay_import_dll_t dll;
+    delay_import_iter_init(&dlls, pe);
+    while (delay_import_next_dll(&dlls, &dll)) {
+        if (!_str_ieq(dll.name, dll_name)) {
+            continue;
+        }
+        if (!func_name) {
+            return true;
+        }
+
+        import_func_iter_t funcs;
+        delay_import_func_iter_init(&funcs, pe, &dll);
+        if (_find_func(&funcs, func_name)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * Import directory decoder, including delay-load and bound imports. Nothing
+ * is decoded up front: descriptors and thunks are read one at a time as the
+ * caller iterates, and names are slices of the image, so checking for a
+ * single import stops as soon as it is found.
+ */
+
+#ifndef IMPORT_TABLE_H
+#define IMPORT_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define IMPORT_DESCRIPTOR_SIZE       20
+#define DELAY_IMPORT_DESCRIPTOR_SIZE 32
+#define BOUND_IMPORT_DESCRIPTOR_SIZE 8
+
+// Delay-load descriptor attribute: addresses are RVAs, not VAs (version 2)
+#define DELAY_IMPORT_RVA_BASED 0x1
+
+// Import Directory Table entry, one for every imported DLL
+typedef struct {
+    uint32_t OriginalFirstThunk;    // RVA of the import lookup table, 0 in some old images
+    uint32_t TimeDateStamp;         // 0 if not bound, -1 if bound with new BIND
+    uint32_t ForwarderChain;        // -1 if no forwarders
+    uint32_t Name;                  // RVA of the DLL name
+    uint32_t FirstThunk;            // RVA of the import address table
+} import_descriptor_t;
+
+// Delay-Load Directory Table entry, one for every delay-loaded DLL
+typedef struct {
+    uint32_t Attributes;                // DELAY_IMPORT_RVA_BASED
+    uint32_t Name;                      // RVA of the DLL name
+    uint32_t ModuleHandle;              // RVA of the HMODULE the helper caches
+    uint32_t DelayImportAddressTable;   // RVA of the IAT
+    uint32_t DelayImportNameTable;      // RVA of the import lookup table
+    uint32_t BoundDelayImportTable;     // RVA of an optional bound IAT
+    uint32_t UnloadDelayImportTable;    // RVA of an optional copy of the IAT
+    uint32_t TimeStamp;                 // 0 if not bound
+} delay_import_descriptor_t;
+
+// Bound Import Directory entry. NumberOfModuleForwarderRefs entries of the
+// same layout follow, for DLLs the module forwards to.
+typedef struct {
+    uint32_t TimeDateStamp;             // of the DLL the imports are bound to
+    uint16_t OffsetModuleName;          // from the start of the directory
+    uint16_t NumberOfModuleForwarderRefs;
+} bound_import_descriptor_t;
+
+// Imported DLL
+typedef struct
+{
+    import_descriptor_t desc;
+    image_str_t         name;
+} import_dll_t;
+
+// Delay-loaded DLL. Addresses of old VA-based descriptors are converted to
+// RVAs.
+typedef struct
+{
+    delay_import_descriptor_t desc;
+    image_str_t               name;
+} delay_import_dll_t;
+
+// DLL the imports were bound to, or a DLL it forwards to
+typedef struct
+{
+    bound_import_descriptor_t desc;
+    image_str_t               name;
+    bool                      forwarder;    // forwarder of the last module
+} bound_import_t;
+
+// Imported function
+typedef struct
+{
+    uint32_t    iat_rva;            // RVA of the IAT slot the loader fills
+    uint64_t    value;              // raw lookup table entry
+    bool        by_ordinal;
+    uint16_t    ordinal;            // if by_ordinal
+    uint16_t    hint;               // index into the export name table, if by name
+    image_str_t name;               // if by name
+} import_func_t;
+
+// Position in the import directory table
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            rva;        // next descriptor, 0 after the last one
+} import_iter_t;
+
+// Position in the lookup table of one DLL
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            lookup_rva; // next lookup table entry, 0 after the last one
+    uint32_t            iat_rva;    // matching IAT slot
+    bool                va_based;   // entries hold VAs of hint/name entries
+} import_func_iter_t;
+
+// Position in the bound import directory
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            base;       // start of the directory, names are relative to it
+    uint32_t            rva;        // next entry
+    uint32_t            end;        // end of the directory, 0 after the last entry
+    size_t              forwarder_num;  // forwarder entries left of the last module
+} bound_import_iter_t;
+
+void import_iter_init(import_iter_t *it, const pe_headers_t *pe);
+bool import_next_dll(import_iter_t *it, import_dll_t *dll);
+
+void import_func_iter_init(import_func_iter_t *it, const pe_headers_t *pe, const import_dll_t *dll);
+bool import_next_func(import_func_iter_t *it, import_func_t *func);
+
+void delay_import_iter_init(import_iter_t *it, const pe_headers_t *pe);
+bool delay_import_next_dll(import_iter_t *it, delay_import_dll_t *dll);
+void delay_import_func_iter_init(import_func_iter_t *it, const pe_headers_t *pe, const delay_import_dll_t *dll);
+
+void bound_import_iter_init(bound_import_iter_t *it, const pe_headers_t *pe);
+bool bound_import_next(bound_import_iter_t *it, bound_import_t *bound);
+
+bool import_find(const pe_headers_t *pe, const char *dll_name, const char *func_name);
+bool delay_import_find(const pe_headers_t *pe, const char *dll_name, const char *func_name);
+
+#endif
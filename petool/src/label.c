@@ -17,6 +17,7 @@ void label_append_char(label_t *label, const char ch)
         label->str = realloc(label->str, label->cap);
     }
     label->str[label->len++] = ch;
+    label->str[label->len] = '\0';
 }
 
 void label_clear(label_t *label)
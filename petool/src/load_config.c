@@ -0,0 +1,124 @@
+#include <string.h>
+#include "load_config.h"
+#include "error.h"
+
+// Decode the present prefix of the load configuration. Fails without an error
+// set if the image has no load config directory.
+bool read_load_config(const pe_headers_t *pe, load_config_t *lc)
+{
+    memset(lc, 0, sizeof(load_config_t));
+    lc->pe32_plus = (pe->optional.magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS);
+
+    data_directory_t dir;
+    if (!pe_data_dir(pe, DATA_DIR_LOAD_CONFIG_TABLE, &dir)) {
+        return false;
+    }
+
+    // The loader trusts the Size field over the directory entry, which old
+    // linkers filled with a fixed value
+    const uint8_t *data = rva_ptr(pe->image, &pe->sections, dir.VirtualAddress, 4);
+    if (!data) {
+        set_error("Load config directory is out of image");
+        return false;
+    }
+    uint32_t size;
+    memcpy(&size, data, 4);
+    if (size < 4) {
+        set_error("Invalid load config size");
+        return false;
+    }
+
+    size_t full_size = lc->pe32_plus ? SCHEMA_LOAD_CONFIG_DIRECTORY_PE32_PLUS_SIZE : SCHEMA_LOAD_CONFIG_DIRECTORY_PE32_SIZE;
+    if (size > full_size) {
+        size = (uint32_t)full_size;
+    }
+    data = rva_ptr(pe->image, &pe->sections, dir.VirtualAddress, size);
+    if (!data) {
+        set_error("Load config directory is out of image");
+        return false;
+    }
+    lc->size = size;
+
+    // Decode the prefix padded with zeros, so missing fields read as zero
+    uint8_t buffer[SCHEMA_LOAD_CONFIG_DIRECTORY_PE32_PLUS_SIZE];
+    memset(buffer, 0, sizeof(buffer));
+    memcpy(buffer, data, size);
+    pe_image_t prefix = { buffer, full_size, false, NULL };
+    if (lc->pe32_plus) {
+        return schema_read_load_config_directory_pe32_plus(&prefix, 0, &lc->dir.pe32_plus);
+    }
+    return schema_read_load_config_directory_pe32(&prefix, 0, &lc->dir.pe32);
+}
+
+// Locate a guard table without reading its entries. Fails without an error set
+// if the image has no such table.
+bool load_config_guard_table(const pe_headers_t *pe, const load_config_t *lc, guard_table_kind_t kind, guard_table_t *table)
+{
+    memset(table, 0, sizeof(guard_table_t));
+
+    uint64_t va, count;
+    switch (kind) {
+    case GUARD_CF_FUNCTIONS:
+        va = LOAD_CONFIG_FIELD(lc, GuardCFFunctionTable);
+        count = LOAD_CONFIG_FIELD(lc, GuardCFFunctionCount);
+        break;
+    case GUARD_IAT_ENTRIES:
+        va = LOAD_CONFIG_FIELD(lc, GuardAddressTakenIatEntryTable);
+        count = LOAD_CONFIG_FIELD(lc, GuardAddressTakenIatEntryCount);
+        break;
+    case GUARD_LONGJUMP_TARGETS:
+        va = LOAD_CONFIG_FIELD(lc, GuardLongJumpTargetTable);
+        count = LOAD_CONFIG_FIELD(lc, GuardLongJumpTargetCount);
+        break;
+    case GUARD_EH_CONTINUATIONS:
+        va = LOAD_CONFIG_FIELD(lc, GuardEHContinuationTable);
+        count = LOAD_CONFIG_FIELD(lc, GuardEHContinuationCount);
+        break;
+    default:
+        set_error("Unknown guard table");
+        return false;
+    }
+    if (va == 0 || count == 0) {
+        return false;
+    }
+
+    // All guard tables share the entry size given by GuardFlags
+    uint32_t guard_flags = (uint32_t)LOAD_CONFIG_FIELD(lc, GuardFlags);
+    size_t entry_size = 4 + ((guard_flags & IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_MASK) >> IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT);
+
+    uint32_t rva;
+    if (!pe_va_to_rva(pe, va, &rva) || count > pe->image->size / entry_size) {
+        set_error("Guard table is out of image");
+        return false;
+    }
+    table->entries = rva_ptr(pe->image, &pe->sections, rva, (size_t)count * entry_size);
+    if (!table->entries) {
+        set_error("Guard table is out of image");
+        return false;
+    }
+    table->num = (size_t)count;
+    table->entry_size = entry_size;
+    return true;
+}
+
+// Find the entry of an RVA. The loader requires the table to be sorted, so
+// only the entries on the search path are read.
+bool guard_table_find(const guard_table_t *table, uint32_t rva, size_t *idx)
+{
+    size_t n = table->num;
+    if (n == 0) {
+        return false;
+    }
+
+    size_t base = 0;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = (guard_table_rva(table, base + half) <= rva) ? base + half : base;
+        n -= half;
+    }
+    if (guard_table_rva(table, base) != rva) {
+        return false;
+    }
+    *idx = base;
+    return true;
+}
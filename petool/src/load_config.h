@@ -0,0 +1,87 @@
+/**
+ * @file
+ *
+ * Load configuration directory decoder. The structure grows with every
+ * Windows release and is versioned by its Size field, so only the prefix the
+ * image has is read and later fields decode as zero. Guard tables are used in
+ * place as spans of entries, decoded only where they are queried.
+ */
+
+#ifndef LOAD_CONFIG_H
+#define LOAD_CONFIG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+#include "schema_gen.h"
+
+// Number of metadata bytes after each RVA of the guard tables
+#define IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_MASK  0xF0000000
+#define IMAGE_GUARD_CF_FUNCTION_TABLE_SIZE_SHIFT 28
+
+// Flags in the first metadata byte of a guard table entry
+#define IMAGE_GUARD_FLAG_FID_SUPPRESSED    0x01
+#define IMAGE_GUARD_FLAG_EXPORT_SUPPRESSED 0x02
+
+// Load configuration of either image format
+typedef struct
+{
+    bool     pe32_plus;
+    uint32_t size;                  // bytes of the structure present in the image
+    union
+    {
+        schema_load_config_directory_pe32_t      pe32;
+        schema_load_config_directory_pe32_plus_t pe32_plus;
+    } dir;
+} load_config_t;
+
+// Value of a field of either format, address-sized fields widened to 64 bits.
+// Fields past the present prefix are zero.
+#define LOAD_CONFIG_FIELD(lc, field) \
+    ((lc)->pe32_plus ? (uint64_t)(lc)->dir.pe32_plus.field : (uint64_t)(lc)->dir.pe32.field)
+
+// Check if a field is within the present prefix. The schema structures are
+// naturally aligned, like the file format, so their offsets are the file ones.
+#define LOAD_CONFIG_HAS(lc, field) \
+    ((lc)->pe32_plus ? \
+        offsetof(schema_load_config_directory_pe32_plus_t, field) + sizeof((lc)->dir.pe32_plus.field) <= (lc)->size : \
+        offsetof(schema_load_config_directory_pe32_t, field) + sizeof((lc)->dir.pe32.field) <= (lc)->size)
+
+typedef enum
+{
+    GUARD_CF_FUNCTIONS,             // valid indirect call targets
+    GUARD_IAT_ENTRIES,              // address-taken IAT entries
+    GUARD_LONGJUMP_TARGETS,         // valid longjmp targets
+    GUARD_EH_CONTINUATIONS,         // valid exception handling continuations
+} guard_table_kind_t;
+
+// Guard table, sorted by RVA
+typedef struct
+{
+    const uint8_t *entries;         // num unaligned entries of entry_size bytes
+    size_t         num;
+    size_t         entry_size;      // 4-byte RVA, then metadata bytes
+} guard_table_t;
+
+bool read_load_config(const pe_headers_t *pe, load_config_t *lc);
+
+bool load_config_guard_table(const pe_headers_t *pe, const load_config_t *lc, guard_table_kind_t kind, guard_table_t *table);
+bool guard_table_find(const guard_table_t *table, uint32_t rva, size_t *idx);
+
+// RVA of a guard table entry
+static __inline uint32_t guard_table_rva(const guard_table_t *table, size_t idx)
+{
+    uint32_t rva;
+    memcpy(&rva, table->entries + idx * table->entry_size, 4);
+    return rva;
+}
+
+// IMAGE_GUARD_FLAG_* of a guard table entry, zero if entries have no metadata
+static __inline uint8_t guard_table_flags(const guard_table_t *table, size_t idx)
+{
+    return (table->entry_size > 4) ? table->entries[idx * table->entry_size + 4] : 0;
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+#include "name_index.h"
+
+// FNV-1a hash of a name
+uint32_t name_hash(const char *name, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void _insert(name_index_entry_t *entries, size_t cap, name_index_entry_t entry)
+{
+    size_t mask = cap - 1;
+    size_t pos = entry.hash & mask;
+    while (entries[pos].idx) {
+        pos = (pos + 1) & mask;
+    }
+    entries[pos] = entry;
+}
+
+// Add a name. If the name is already indexed, the earlier element is still
+// found first. Borrowed entries are copied first.
+void name_index_add(name_index_t *index, const char *name, size_t len, size_t idx)
+{
+    // Keep load factor under 1/2
+    if ((index->size + 1) * 2 > index->cap || index->borrowed) {
+        size_t new_cap = index->cap ? index->cap : 16;
+        if ((index->size + 1) * 2 > new_cap) {
+            new_cap *= 2;
+        }
+        name_index_entry_t *entries = calloc(new_cap, sizeof(name_index_entry_t));
+        for (size_t i = 0; i < index->cap; i++) {
+            if (index->entries[i].idx) {
+                _insert(entries, new_cap, index->entries[i]);
+            }
+        }
+        if (!index->borrowed) {
+            free(index->entries);
+        }
+        index->entries = entries;
+        index->cap = new_cap;
+        index->borrowed = false;
+    }
+
+    name_index_entry_t entry = { name_hash(name, len), (uint32_t)idx + 1 };
+    _insert(index->entries, index->cap, entry);
+    index->size++;
+}
+
+// Find element index by name. Only elements with equal hashes are compared.
+bool name_index_find(const name_index_t *index, const char *name, size_t len,
+    name_index_key_fn_t key, const void *ctx, size_t *idx)
+{
+    if (index->cap == 0) {
+        return false;
+    }
+
+    uint32_t hash = name_hash(name, len);
+    size_t mask = index->cap - 1;
+    for (size_t pos = hash & mask; index->entries[pos].idx; pos = (pos + 1) & mask) {
+        const name_index_entry_t *entry = &index->entries[pos];
+        if (entry->hash != hash) {
+            continue;
+        }
+        const char *candidate = key(ctx, entry->idx - 1);
+        if (strncmp(candidate, name, len) == 0 && candidate[len] == '\0') {
+            *idx = entry->idx - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Find element index by name, for elements whose names are not NUL-terminated
+bool name_index_find_len(const name_index_t *index, const char *name, size_t len,
+    name_index_key_len_fn_t key, const void *ctx, size_t *idx)
+{
+    if (index->cap == 0) {
+        return false;
+    }
+
+    uint32_t hash = name_hash(name, len);
+    size_t mask = index->cap - 1;
+    for (size_t pos = hash & mask; index->entries[pos].idx; pos = (pos + 1) & mask) {
+        const name_index_entry_t *entry = &index->entries[pos];
+        if (entry->hash != hash) {
+            continue;
+        }
+        size_t candidate_len;
+        const char *candidate = key(ctx, entry->idx - 1, &candidate_len);
+        if (candidate_len == len && memcmp(candidate, name, len) == 0) {
+            *idx = entry->idx - 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+void name_index_free(name_index_t *index)
+{
+    if (!index->borrowed) {
+        free(index->entries);
+    }
+    index->borrowed = false;
+    index->entries = NULL;
+    index->cap = 0;
+    index->size = 0;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file
+ *
+ * Hash index from names to element indices of a store. The index keeps only
+ * hashes and indices; names are looked up through a key function, so the
+ * indexed store may grow and move freely.
+ */
+
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Get name of element idx in indexed collection ctx
+typedef const char * (*name_index_key_fn_t)(const void *ctx, size_t idx);
+
+// Get name of element idx that is not NUL-terminated, with its length
+typedef const char * (*name_index_key_len_fn_t)(const void *ctx, size_t idx, size_t *len);
+
+typedef struct name_index_entry_t
+{
+    uint32_t hash;
+    uint32_t idx;               // element index + 1, 0 for an empty slot
+} name_index_entry_t;
+
+typedef struct name_index_t
+{
+    name_index_entry_t *entries;
+    size_t              cap;    // power of 2, or 0
+    size_t              size;
+    bool                borrowed; // entries are read-only memory not owned by the index
+} name_index_t;
+
+#define name_index_init() { NULL, 0, 0, false }
+
+uint32_t name_hash(const char *name, size_t len);
+
+void name_index_add(name_index_t *index, const char *name, size_t len, size_t idx);
+bool name_index_find(const name_index_t *index, const char *name, size_t len,
+    name_index_key_fn_t key, const void *ctx, size_t *idx);
+bool name_index_find_len(const name_index_t *index, const char *name, size_t len,
+    name_index_key_len_fn_t key, const void *ctx, size_t *idx);
+void name_index_free(name_index_t *index);
+
+#endif
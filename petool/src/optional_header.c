@@ -1,68 +1,113 @@
+#include <string.h>
 #include "optional_header.h"
 #include "error.h"
 
-bool read_optional_header(FILE *infile, optional_header_t *header)
+static const char *data_directory_names[DATA_DIR_NUM] = {
+    "Export Table",
+    "Import Table",
+    "Resource Table",
+    "Exception Table",
+    "Certificate Table",
+    "Base Relocation Table",
+    "Debug",
+    "Architecture",
+    "Global Ptr",
+    "TLS Table",
+    "Load Config Table",
+    "Bound Import",
+    "IAT",
+    "Delay Import Descriptor",
+    "CLR Runtime Header",
+    "Reserved",
+};
+
+// Decode the optional header of size bytes, as given by SizeOfOptionalHeader
+// in the COFF File Header. Fields past a truncated header read as zero, and
+// the number of data directories is limited by both NumberOfRvaAndSizes and
+// the header size, like the loader does.
+bool read_optional_header(const pe_image_t *image, size_t offset, size_t size, optional_header_t *header)
 {
-    uint16_t magic;
-    if (fread(&magic, 2, 1, infile) < 1) {
-        set_error("Failed to read magic number from optional header");
+    memset(header, 0, sizeof(optional_header_t));
+
+    const uint8_t *data = image_ptr(image, offset, size);
+    if (!data) {
+        set_error("Optional header is out of image");
         return false;
     }
-
-    if (fseek(infile, -2, SEEK_CUR)) {
-        set_error("Failed to set back after reading macic number from optional header");
+    if (size < 2) {
+        set_error("Image has no optional header");
         return false;
     }
+    memcpy(&header->magic, data, 2);
 
-    if (magic == OPTIONAL_HEADER_MAGIC_PE32) {
-        fread(header, sizeof(optional_header_pe32_t), 1, infile);
-    } else if (magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS) {
-        fread(header, sizeof(optional_header_pe32_plus_t), 1, infile);
+    size_t fields_size;
+    uint32_t dir_num;
+    if (header->magic == OPTIONAL_HEADER_MAGIC_PE32) {
+        fields_size = OPTIONAL_HEADER_PE32_SIZE;
+        memcpy(&header->fields.pe32, data, (size < fields_size) ? size : fields_size);
+        dir_num = header->fields.pe32.NumberOfRvaAndSizes;
+    } else if (header->magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS) {
+        fields_size = OPTIONAL_HEADER_PE32_PLUS_SIZE;
+        memcpy(&header->fields.pe32_plus, data, (size < fields_size) ? size : fields_size);
+        dir_num = header->fields.pe32_plus.NumberOfRvaAndSizes;
     } else {
         set_error("Invalid magic in optional header");
         return false;
     }
 
+    size_t dir_fit = (size > fields_size) ? (size - fields_size) / DATA_DIRECTORY_SIZE : 0;
+    if (dir_num > dir_fit) {
+        dir_num = (uint32_t)dir_fit;
+    }
+    if (dir_num > DATA_DIR_NUM) {
+        dir_num = DATA_DIR_NUM;
+    }
+    memcpy(header->dirs, data + fields_size, dir_num * DATA_DIRECTORY_SIZE);
+    header->dir_num = dir_num;
     return true;
 }
 
-void print_optional_header(optional_header_t *header)
+void print_optional_header(const optional_header_t *header)
 {
-    if (header->Magic == OPTIONAL_HEADER_MAGIC_PE32) {
-        optional_header_pe32_t *h = (optional_header_pe32_t *)header;
+    bool pe32_plus = (header->magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS);
 
-        printf("Optional Header:\n");
-        printf("  Standard Fields:\n");
-        printf("    Magic: 0x%x (PE32)\n", h->Magic);
-        printf("    MajorLinkerVersion: %d\n", h->MajorLinkerVersion);
-        printf("    MinorLinkerVersion: %d\n", h->MinorLinkerVersion);
-        printf("    SizeOfCode: %d\n", h->SizeOfCode);
-        printf("    SizeOfInitializedData: %d\n", h->SizeOfInitializedData);
-        printf("    SizeOfUninitializedData: %d\n", h->SizeOfUninitializedData);
-        printf("    AddressOfEntryPoint: %d\n", h->AddressOfEntryPoint);
-        printf("    BaseOfCode: %d\n", h->BaseOfCode);
-        printf("    BaseOfData: %d\n", h->BaseOfData);
-        printf("  Windows-Specific Fields:\n");
-        printf("    ImageBase: %d\n", h->ImageBase);
-        printf("    SectionAlignment: %d\n", h->SectionAlignment);
-        printf("    FileAlignment: %d\n", h->FileAlignment);
-        printf("    MajorOperatingSystemVersion: %d\n", h->MajorOperatingSystemVersion);
-        printf("    MinorOperatingSystemVersion: %d\n", h->MinorOperatingSystemVersion);
-        printf("    MajorImageVersion: %d\n", h->MajorImageVersion);
-        printf("    MinorImageVersion: %d\n", h->MinorImageVersion);
-        printf("    MajorSubsystemVersion: %d\n", h->MajorSubsystemVersion);
-        printf("    MinorSubsystemVersion: %d\n", h->MinorSubsystemVersion);
-        printf("    Win32VersionValue: %d\n", h->Win32VersionValue);
-        printf("    SizeOfImage: %d\n", h->SizeOfImage);
-        printf("    SizeOfHeaders: %d\n", h->SizeOfHeaders);
-        printf("    CheckSum: %d\n", h->CheckSum);
-        printf("    Subsystem: %d\n", h->Subsystem);
-        printf("    DllCharacteristics: %d\n", h->DllCharacteristics);
-        printf("    SizeOfStackReserve: %d\n", h->SizeOfStackReserve);
-        printf("    SizeOfStackCommit: %d\n", h->SizeOfStackCommit);
-        printf("    SizeOfHeapReserve: %d\n", h->SizeOfHeapReserve);
-        printf("    SizeOfHeapCommit: %d\n", h->SizeOfHeapCommit);
-        printf("    LoaderFlags: %d\n", h->LoaderFlags);
-        printf("    NumberOfRvaAndSizes: %d\n", h->NumberOfRvaAndSizes);
-    } 
-}
\ No newline at end of file
+    printf("Optional Header:\n");
+    printf("  Standard Fields:\n");
+    printf("    Magic: 0x%x (%s)\n", header->magic, pe32_plus ? "PE32+" : "PE32");
+    printf("    MajorLinkerVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MajorLinkerVersion));
+    printf("    MinorLinkerVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MinorLinkerVersion));
+    printf("    SizeOfCode: %u\n", (unsigned int)OPTIONAL_FIELD(header, SizeOfCode));
+    printf("    SizeOfInitializedData: %u\n", (unsigned int)OPTIONAL_FIELD(header, SizeOfInitializedData));
+    printf("    SizeOfUninitializedData: %u\n", (unsigned int)OPTIONAL_FIELD(header, SizeOfUninitializedData));
+    printf("    AddressOfEntryPoint: 0x%x\n", (unsigned int)OPTIONAL_FIELD(header, AddressOfEntryPoint));
+    printf("    BaseOfCode: 0x%x\n", (unsigned int)OPTIONAL_FIELD(header, BaseOfCode));
+    if (!pe32_plus) {
+        printf("    BaseOfData: 0x%x\n", header->fields.pe32.BaseOfData);
+    }
+    printf("  Windows-Specific Fields:\n");
+    printf("    ImageBase: 0x%llx\n", (unsigned long long)OPTIONAL_FIELD(header, ImageBase));
+    printf("    SectionAlignment: %u\n", (unsigned int)OPTIONAL_FIELD(header, SectionAlignment));
+    printf("    FileAlignment: %u\n", (unsigned int)OPTIONAL_FIELD(header, FileAlignment));
+    printf("    MajorOperatingSystemVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MajorOperatingSystemVersion));
+    printf("    MinorOperatingSystemVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MinorOperatingSystemVersion));
+    printf("    MajorImageVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MajorImageVersion));
+    printf("    MinorImageVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MinorImageVersion));
+    printf("    MajorSubsystemVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MajorSubsystemVersion));
+    printf("    MinorSubsystemVersion: %u\n", (unsigned int)OPTIONAL_FIELD(header, MinorSubsystemVersion));
+    printf("    Win32VersionValue: %u\n", (unsigned int)OPTIONAL_FIELD(header, Win32VersionValue));
+    printf("    SizeOfImage: %u\n", (unsigned int)OPTIONAL_FIELD(header, SizeOfImage));
+    printf("    SizeOfHeaders: %u\n", (unsigned int)OPTIONAL_FIELD(header, SizeOfHeaders));
+    printf("    CheckSum: 0x%08x\n", (unsigned int)OPTIONAL_FIELD(header, CheckSum));
+    printf("    Subsystem: %u\n", (unsigned int)OPTIONAL_FIELD(header, Subsystem));
+    printf("    DllCharacteristics: 0x%04x\n", (unsigned int)OPTIONAL_FIELD(header, DllCharacteristics));
+    printf("    SizeOfStackReserve: %llu\n", (unsigned long long)OPTIONAL_FIELD(header, SizeOfStackReserve));
+    printf("    SizeOfStackCommit: %llu\n", (unsigned long long)OPTIONAL_FIELD(header, SizeOfStackCommit));
+    printf("    SizeOfHeapReserve: %llu\n", (unsigned long long)OPTIONAL_FIELD(header, SizeOfHeapReserve));
+    printf("    SizeOfHeapCommit: %llu\n", (unsigned long long)OPTIONAL_FIELD(header, SizeOfHeapCommit));
+    printf("    LoaderFlags: 0x%x\n", (unsigned int)OPTIONAL_FIELD(header, LoaderFlags));
+    printf("    NumberOfRvaAndSizes: %u\n", (unsigned int)OPTIONAL_FIELD(header, NumberOfRvaAndSizes));
+    printf("  Data Directories:\n");
+    for (uint32_t i = 0; i < header->dir_num; i++) {
+        printf("    %s: RVA 0x%x, Size %u\n", data_directory_names[i], header->dirs[i].VirtualAddress, header->dirs[i].Size);
+    }
+}
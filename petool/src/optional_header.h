@@ -1,9 +1,23 @@
+/**
+ * @file
+ *
+ * Optional header decoder. The whole header, SizeOfOptionalHeader bytes, is
+ * fetched from the image at once and decoded for both PE32 and PE32+, with
+ * the data directories that NumberOfRvaAndSizes and the header size allow.
+ */
+
 #ifndef OPTIONAL_HEADER_H
 #define OPTIONAL_HEADER_H
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include "image.h"
+
+#define OPTIONAL_HEADER_PE32_SIZE      96     // up to the data directories
+#define OPTIONAL_HEADER_PE32_PLUS_SIZE 112
+#define DATA_DIRECTORY_SIZE            8
+#define DATA_DIR_NUM                   16
 
 typedef struct {
     uint32_t VirtualAddress;
@@ -45,8 +59,6 @@ typedef struct {
     uint32_t SizeOfHeapCommit;
     uint32_t LoaderFlags;
     uint32_t NumberOfRvaAndSizes;
-
-    data_directory_t DataDirectory[];
 } optional_header_pe32_t;
 
 // Optional Header: PE32+ format
@@ -83,27 +95,53 @@ typedef struct {
     uint64_t SizeOfHeapCommit;
     uint32_t LoaderFlags;
     uint32_t NumberOfRvaAndSizes;
-
-    data_directory_t DataDirectory[];
 } optional_header_pe32_plus_t;
 
-// Optional Header: can have PE32 or PE32+ format
-typedef union {
-    uint16_t Magic;
-    optional_header_pe32_t pe32;
-    optional_header_pe32_plus_t pe32_plus;
-} optional_header_t;
-
 // Optional Header: Magic Number
 typedef enum {
     OPTIONAL_HEADER_MAGIC_PE32      = 0x10B,
     OPTIONAL_HEADER_MAGIC_PE32_PLUS = 0x20B,
 } optional_header_magic_t;
 
+// Indices of data directories
+typedef enum {
+    DATA_DIR_EXPORT_TABLE = 0,
+    DATA_DIR_IMPORT_TABLE,
+    DATA_DIR_RESOURCE_TABLE,
+    DATA_DIR_EXCEPTION_TABLE,
+    DATA_DIR_CERTIFICATE_TABLE,
+    DATA_DIR_BASE_RELOCATION_TABLE,
+    DATA_DIR_DEBUG,
+    DATA_DIR_ARCHITECTURE,
+    DATA_DIR_GLOBAL_PTR,
+    DATA_DIR_TLS_TABLE,
+    DATA_DIR_LOAD_CONFIG_TABLE,
+    DATA_DIR_BOUND_IMPORT,
+    DATA_DIR_IAT,
+    DATA_DIR_DELAY_IMPORT_DESCRIPTOR,
+    DATA_DIR_CLR_RUNTIME_HEADER,
+    DATA_DIR_RESERVED,
+} data_directory_index_t;
 
+// Optional Header of either format with its data directories
+typedef struct
+{
+    uint16_t magic;                 // OPTIONAL_HEADER_MAGIC_PE32 or OPTIONAL_HEADER_MAGIC_PE32_PLUS
+    union
+    {
+        optional_header_pe32_t      pe32;
+        optional_header_pe32_plus_t pe32_plus;
+    } fields;
+    uint32_t         dir_num;       // number of valid entries in dirs
+    data_directory_t dirs[DATA_DIR_NUM];
+} optional_header_t;
 
-bool read_optional_header(FILE *infile, optional_header_t *header);
-void print_optional_header(optional_header_t *header);
+// Value of a field of either format, 64-bit fields of PE32+ included
+#define OPTIONAL_FIELD(header, field) \
+    (((header)->magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS) ? \
+        (uint64_t)(header)->fields.pe32_plus.field : (uint64_t)(header)->fields.pe32.field)
 
+bool read_optional_header(const pe_image_t *image, size_t offset, size_t size, optional_header_t *header);
+void print_optional_header(const optional_header_t *header);
 
 #endif
@@ -0,0 +1,27 @@
+#include <string.h>
+#include "pe_headers.h"
+#include "pe_signature.h"
+#include "error.h"
+
+// Decode the headers of an image up to and including the section table
+bool read_pe_headers(const pe_image_t *image, pe_headers_t *pe)
+{
+    memset(pe, 0, sizeof(pe_headers_t));
+    pe->image = image;
+
+    if (!read_pe_signature(image, &pe->coff_offset) || !read_coff_file_header(image, pe->coff_offset, &pe->coff)) {
+        return false;
+    }
+    pe->optional_offset = pe->coff_offset + COFF_FILE_HEADER_SIZE;
+
+    if (!read_optional_header(image, pe->optional_offset, pe->coff.SizeOfOptionalHeader, &pe->optional)) {
+        return false;
+    }
+
+    return read_section_table(image, pe->coff_offset, &pe->coff, &pe->sections);
+}
+
+void pe_headers_free(pe_headers_t *pe)
+{
+    section_table_free(&pe->sections);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file
+ *
+ * Headers every directory decoder needs: location of the COFF File Header,
+ * format of the optional header, data directories and the section table.
+ */
+
+#ifndef PE_HEADERS_H
+#define PE_HEADERS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "coff_header.h"
+#include "optional_header.h"
+#include "section_table.h"
+
+typedef struct
+{
+    const pe_image_t   *image;
+    size_t              coff_offset;
+    coff_file_header_t  coff;
+    size_t              optional_offset;
+    optional_header_t   optional;
+    section_table_t     sections;
+} pe_headers_t;
+
+bool read_pe_headers(const pe_image_t *image, pe_headers_t *pe);
+void pe_headers_free(pe_headers_t *pe);
+
+// Get a data directory, false if the image has no such entry or it is empty
+static __inline bool pe_data_dir(const pe_headers_t *pe, data_directory_index_t index, data_directory_t *dir)
+{
+    if ((uint32_t)index >= pe->optional.dir_num || pe->optional.dirs[index].VirtualAddress == 0) {
+        return false;
+    }
+    *dir = pe->optional.dirs[index];
+    return true;
+}
+
+// Size of pointers, thunks and other address-sized fields
+static __inline size_t pe_addr_size(const pe_headers_t *pe)
+{
+    return (pe->optional.magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS) ? 8 : 4;
+}
+
+// Convert a VA stored in the image to an RVA, false if it is out of the image.
+// VAs are relative to the preferred load address.
+static __inline bool pe_va_to_rva(const pe_headers_t *pe, uint64_t va, uint32_t *rva)
+{
+    uint64_t image_base = OPTIONAL_FIELD(&pe->optional, ImageBase);
+    if (va < image_base || va - image_base > UINT32_MAX) {
+        return false;
+    }
+    *rva = (uint32_t)(va - image_base);
+    return true;
+}
+
+#endif
@@ -2,31 +2,23 @@
 #include "pe_signature.h"
 #include "error.h"
 
-bool read_pe_signature(FILE *infile)
+// Check PE signature. On success, coff_offset is set to the offset of the COFF
+// File Header, which immediately follows the signature.
+bool read_pe_signature(const pe_image_t *image, size_t *coff_offset)
 {
     if (has_error()) {
         return false;
     }
 
-    if (fseek(infile, 0x3C, SEEK_SET)) {
-        set_error("Failed to go to 0x3C");
-        return false;
-    }
-
     uint32_t pe_sig_offset;
-    if (fread(&pe_sig_offset, 4, 1, infile) < 1) {
+    if (!image_read_u32(image, 0x3C, &pe_sig_offset)) {
         set_error("Failed to read PE signature offset");
         return false;
     }
 
-    if (fseek(infile, pe_sig_offset, SEEK_SET)) {
-        set_error("Failed to seek PE signature");
-        return false;
-    }
-
-    uint8_t pe_sig_sample[4] = "PE\0\0";
-    uint8_t pe_sig[4];
-    if (fread(&pe_sig, 1, 4, infile) < 4) {
+    const uint8_t pe_sig_sample[4] = "PE\0\0";
+    const uint8_t *pe_sig = image_ptr(image, pe_sig_offset, 4);
+    if (!pe_sig) {
         set_error("Failed to read PE signature");
         return false;
     }
@@ -37,6 +29,7 @@ bool read_pe_signature(FILE *infile)
             return false;
         }
     }
-    
+
+    *coff_offset = (size_t)pe_sig_offset + 4;
     return true;
 }
@@ -2,8 +2,9 @@
 #define PE_SIGNATURE_H
 
 #include <stdbool.h>
-#include <stdio.h>
+#include <stddef.h>
+#include "image.h"
 
-bool read_pe_signature(FILE *infile);
+bool read_pe_signature(const pe_image_t *image, size_t *coff_offset);
 
 #endif
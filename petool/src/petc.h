@@ -1,6 +1,10 @@
+#pragma once
+
 #ifndef PETC_H
 #define PETC_H
 
-void parse_file(const char *fname);
+#include <stdbool.h>
+
+bool parse_file(const char *fname);
 
 #endif
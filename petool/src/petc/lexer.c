@@ -1,79 +1,96 @@
-#include "../vis_struct.h"
-#include "../label.h"
+#include <stdio.h>
+#include <stdint.h>
+#include "petc_inner.h"
 
-// Lexer state
+// Lexer state: current token and its position
+token_t token;
+unsigned int token_line = 0;
+unsigned int token_column = 0;
 
-typedef enum
+// Skip whitespace and comments. A comment starts with '#' and runs to the end of line.
+static void skip_ws()
 {
-    TOKEN_NUMBER,
-    TOKEN_WORD,
-    TOKEN_STRING,
-    TOKEN_EOF,
-    TOKEN_COMMA,
-    TOKEN_HORIZ_SEP,
-    TOKEN_VERT_SEP,
-    TOKEN_LEFT_BR,
-    TOKEN_RIGHT_BR,
-} token_type_t;
-
-typedef struct
-{
-    token_type_t type;
-    vis_value_t value;
-} token_number_t;
-
-typedef struct
-{
-    token_type_t type;
-    label_t word;
-} token_word_t;
-
-typedef struct
-{
-    token_type_t type;
-    label_t string;
-} token_string_t;
+    while (is_ws() || is_char('#')) {
+        if (is_char('#')) {
+            while (!is_char('\n') && !is_eof()) {
+                scan();
+            }
+        } else {
+            scan();
+        }
+    }
+}
 
-typedef union
+// Prepare lexer for a new source and read the first token
+void lexer_init()
 {
-    token_type_t type;
-    token_number_t number;
-    token_word_t word;
-    token_string_t string;
-} token_t;
-
-static token_t token;
+    token.type = TOKEN_EOF;
+    token.text = NULL;
+    token.len = 0;
+    skip_ws();
+    lex();
+}
 
 void lex()
 {
+    token_line = scanner_line();
+    token_column = scanner_column();
+
     // Get token under cursor
     if (is_digit())
     {
-        token.type = TOKEN_NUMBER;
-        label_t buf = label_init();
-        while (is_digit()) {
-            label_append_char(&buf, sym());
+        unsigned int base = 10;
+        if (is_char('0') && scanner.pos + 1 < scanner.end && (scanner.pos[1] == 'x' || scanner.pos[1] == 'X')) {
+            base = 16;
+            scan();
+            scan();
+        }
+
+        const char *start = scanner.pos;
+        vis_value_t value = 0;
+        bool overflow = false;
+        while ((base == 16) ? is_hex_digit() : is_digit()) {
+            int c = sym();
+            unsigned int digit = (c <= '9') ? c - '0' : (c | 0x20) - 'a' + 10;
+            overflow = overflow || value > (UINT64_MAX - digit) / base;
+            value = value * base + digit;
             scan();
         }
-        token.number.value = strtoull(buf.str, NULL, 10);
+
+        if (scanner.pos == start || overflow || is_letter() || is_char('_')) {
+            token.type = TOKEN_INVALID;
+        } else {
+            token.type = TOKEN_NUMBER;
+            token.value = value;
+        }
     } else if (is_letter() || is_char('_')) {
         token.type = TOKEN_WORD;
+        token.text = scanner.pos;
         while (is_letter() || is_digit() || is_char('_') || is_char('+')) {
-            label_append_char(&token.word.word, sym());
             scan();
         }
+        token.len = scanner.pos - token.text;
     } else if (is_char('[')) {
+        // The string is the text between brackets without surrounding whitespace
         token.type = TOKEN_STRING;
+        scan();
         while (is_ws()) {
             scan();
         }
+        token.text = scanner.pos;
+        const char *last = scanner.pos;
         while (!is_char(']') && !is_eof()) {
-            label_append_char(&token.string.string, sym());
+            if (!is_ws()) {
+                last = scanner.pos + 1;
+            }
             scan();
         }
+        token.len = last - token.text;
 
         if (is_eof()) {
-            // TODO: Report lexer error
+            token.type = TOKEN_INVALID;
+        } else {
+            scan();
         }
     } else if (is_char('-')) {
         token.type = TOKEN_HORIZ_SEP;
@@ -88,13 +105,43 @@ void lex()
     } else if (is_char('|')) {
         token.type = TOKEN_VERT_SEP;
         scan();
+    } else if (is_char('(')) {
+        token.type = TOKEN_LEFT_BR;
+        scan();
+    } else if (is_char(')')) {
+        token.type = TOKEN_RIGHT_BR;
+        scan();
+    } else if (is_char('/')) {
+        token.type = TOKEN_SLASH;
+        scan();
     } else {
-        // TODO: Report lexer error
+        token.type = TOKEN_INVALID;
+        return;
     }
 
     // Skip whitespace after obtained token
-    while (is_ws()) {
-        scan();
-    }
+    skip_ws();
 }
 
+// Describe a token for error messages
+const char * token_to_str(const token_t *t)
+{
+    static char buf[MAX_NAME_LEN + 100];
+
+    switch (t->type)
+    {
+        case TOKEN_NUMBER: sprintf_s(buf, sizeof(buf), "number %llu", t->value); return buf;
+        case TOKEN_WORD: sprintf_s(buf, sizeof(buf), "word '%.*s'", (int)(t->len < MAX_NAME_LEN ? t->len : MAX_NAME_LEN), t->text); return buf;
+        case TOKEN_STRING: return "description";
+        case TOKEN_EOF: return "end of file";
+        case TOKEN_COMMA: return "','";
+        case TOKEN_HORIZ_SEP: return "separator line";
+        case TOKEN_VERT_SEP: return "'|'";
+        case TOKEN_LEFT_BR: return "'('";
+        case TOKEN_RIGHT_BR: return "')'";
+        case TOKEN_SLASH: return "'/'";
+    }
+
+    sprintf_s(buf, sizeof(buf), "character %s", char_to_str(sym()));
+    return buf;
+}
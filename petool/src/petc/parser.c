@@ -4,41 +4,45 @@
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
-#include "../vis_struct.h"
-#include "../label.h"
+#include "petc_inner.h"
+#include "../petc.h"
+#include "../error.h"
 
 #define MAX_ERROR_LEN 5000      // max length of error message
-#define MAX_VALUE_LEN 10        // max length of a value string
-#define MAX_VARIATIONS 5        // max number of structure variations
-#define MAX_STRING_LEN 5000     // max length of description string
-#define MAX_WORD_LEN 100
+#define MAX_VARIATIONS 16       // max number of structure variations
 
+/*
+** Grammar of a petc file:
+**
+**   file       = { struct_def | field_def } EOF
+**   struct_def = ( "STRUCT" | "STRUCTURE" ) WORD [ "OF" WORD { "," WORD } ]
+**                SEP { [ "(" WORD { "," WORD } ")" ] field_row } SEP
+**   field_row  = NUMBER { "/" NUMBER } "|" WORD "|" WORD [ STRING ]
+**   field_def  = "FIELD" WORD "OF" WORD [ "(" WORD ")" ] SEP { value_row } SEP
+**   value_row  = WORD "|" NUMBER [ STRING ]
+**
+** A structure with variations defines one visual structure per variation,
+** named "Name(Variation)". Field sizes may be given per variation, and a
+** variation list before a field row limits it to those variations. A field
+** definition of a structure with variations applies to all of them, unless
+** a variation is given.
+*/
 
+/* Common data: used when parsing any type of definition, structure or field */
 
+// Name of the affected structure, may have variations
 static char struct_name[MAX_NAME_LEN + 1] = "";
 static char struct_variation_list[MAX_VARIATIONS][MAX_NAME_LEN + 1];
 static size_t struct_variation_num = 0;
 
-static vis_struct_t *structs[MAX_VARIATIONS];
-static size_t struct_num = 0;
-
-
-/* Common data: used when parsing any type of definition, structure or field */
-
-// Name of the affected structure, may have variations
-
 // Description of current item
 static char description[MAX_DESCR_LEN + 1] = "";
-static size_t descr_idx = 0;
-
 
 
 /* Data from structure definition parsing */
 
-
 // Variations the field is applied to
-static char field_variations[MAX_VARIATIONS][MAX_NAME_LEN + 1];
-static size_t field_variation_num = 0;
+static bool field_variations[MAX_VARIATIONS];
 
 // Field data in structure definition
 static size_t field_sizes[MAX_VARIATIONS];
@@ -49,10 +53,6 @@ static char field_name[MAX_NAME_LEN + 1] = "";
 
 /* Data from field definition parsing */
 
-// Field being defined
-static char target_field[MAX_NAME_LEN + 1] = "";
-static vis_field_t *current_field = NULL;
-
 // Value name in field definition
 static char value_name[MAX_NAME_LEN + 1] = "";
 
@@ -62,19 +62,23 @@ static vis_value_t value = 0;
 
 // Error status
 static char error[MAX_ERROR_LEN + 1] = "";
-static int error_pos = 0;
 static bool status = true;
 
-void err(const char *format, ...)
+// Record the first error, with position of the current token
+static void err(const char *format, ...)
 {
+    if (!status) {
+        return;
+    }
+    status = false;
+
+    int len = sprintf_s(error, MAX_ERROR_LEN + 1, "%u:%u: ", token_line, token_column);
     va_list args;
     va_start(args, format);
-    vfprintf(stderr, format, args);
+    vsnprintf(error + len, MAX_ERROR_LEN + 1 - len, format, args);
     va_end(args);
 }
 
-
-
 // Check current parser status, and return immediately, if something is wrong
 #define check_status()                                                          \
 do {                                                                            \
@@ -91,31 +95,372 @@ do {
 } while (0)
 
 
+/*
+** Token helpers
+*/
+
+static bool is_token(token_type_t type)
+{
+    return (token.type == type);
+}
+
+// Skip current token if it has given type
+static bool accept(token_type_t type)
+{
+    if (status && is_token(type)) {
+        lex();
+        return true;
+    }
+    return false;
+}
+
+static bool is_keyword(const char *keyword)
+{
+    return (token.type == TOKEN_WORD && token.len == strlen(keyword) && memcmp(token.text, keyword, token.len) == 0);
+}
+
+static void expect(token_type_t type, const char *what)
+{
+    check_status();
+    if (!is_token(type)) {
+        err("Expected %s, got %s", what, token_to_str(&token));
+        return;
+    }
+    lex();
+}
+
+static void expect_keyword(const char *keyword)
+{
+    check_status();
+    if (!is_keyword(keyword)) {
+        err("Expected '%s', got %s", keyword, token_to_str(&token));
+        return;
+    }
+    lex();
+}
+
+// Copy current word into buffer and move to next token
+static void parse_word(char *buffer, const char *what)
+{
+    check_status();
+    if (!is_token(TOKEN_WORD)) {
+        err("Expected %s, got %s", what, token_to_str(&token));
+        return;
+    }
+    if (token.len > MAX_NAME_LEN) {
+        err("Name is too long: %.*s", MAX_NAME_LEN, token.text);
+        return;
+    }
+    memcpy(buffer, token.text, token.len);
+    buffer[token.len] = '\0';
+    lex();
+}
+
+static void parse_number(vis_value_t *number)
+{
+    check_status();
+    if (!is_token(TOKEN_NUMBER)) {
+        err("Expected number, got %s", token_to_str(&token));
+        return;
+    }
+    *number = token.value;
+    lex();
+}
+
+// Optional description, empty if missing. Whitespace inside it, including
+// line breaks and indentation of continuation lines, becomes single spaces.
+static void parse_description()
+{
+    check_status();
+    description[0] = '\0';
+    if (!is_token(TOKEN_STRING)) {
+        return;
+    }
+
+    size_t len = 0;
+    bool space = false;
+    for (size_t i = 0; i < token.len; i++) {
+        char ch = token.text[i];
+        if (ch == ' ' || ch == '\t' || ch == '\v' || ch == '\f' || ch == '\r' || ch == '\n') {
+            space = true;
+            continue;
+        }
+        if (len + space + 1 > MAX_DESCR_LEN) {
+            err("Description is too long");
+            return;
+        }
+        if (space) {
+            description[len++] = ' ';
+            space = false;
+        }
+        description[len++] = ch;
+    }
+    description[len] = '\0';
+    lex();
+}
+
+// Name of the visual structure of a variation
+static void variation_struct_name(char *buffer, size_t size, const char *name, const char *variation)
+{
+    sprintf_s(buffer, size, "%s(%s)", name, variation);
+}
+
+static size_t find_variation(const char *name)
+{
+    for (size_t i = 0; i < struct_variation_num; i++) {
+        if (strcmp(struct_variation_list[i], name) == 0) {
+            return i;
+        }
+    }
+    return struct_variation_num;
+}
+
+
+/*
+** Structure definition
+*/
 
+// ( "(" WORD { "," WORD } ")" )
+static void parse_field_variations()
+{
+    check_status();
+    for (size_t i = 0; i < MAX_VARIATIONS; i++) {
+        field_variations[i] = !is_token(TOKEN_LEFT_BR);
+    }
+    if (!is_token(TOKEN_LEFT_BR)) {
+        return;
+    }
+
+    if (struct_variation_num == 0) {
+        err("Structure %s has no variations", struct_name);
+        return;
+    }
+
+    lex();
+    do {
+        char name[MAX_NAME_LEN + 1];
+        parse_word(name, "variation name");
+        check_status();
+
+        size_t idx = find_variation(name);
+        if (idx == struct_variation_num) {
+            err("Unknown variation %s of structure %s", name, struct_name);
+            return;
+        }
+        field_variations[idx] = true;
+    } while (accept(TOKEN_COMMA));
+    expect(TOKEN_RIGHT_BR, "')'");
+}
+
+// NUMBER { "/" NUMBER } "|" WORD "|" WORD [ STRING ]
+static void parse_field_row(vis_struct_t **structs, size_t struct_num)
+{
+    field_size_num = 0;
+    do {
+        vis_value_t size;
+        parse_number(&size);
+        check_status();
+        if (field_size_num == struct_num) {
+            err("Too many field sizes");
+            return;
+        }
+        field_sizes[field_size_num++] = (size_t)size;
+    } while (accept(TOKEN_SLASH));
+
+    if (field_size_num != 1 && field_size_num != struct_num) {
+        err("Expected 1 or %u field sizes, got %u", (unsigned int)struct_num, (unsigned int)field_size_num);
+        return;
+    }
+
+    expect(TOKEN_VERT_SEP, "'|'");
+    char type_name[MAX_NAME_LEN + 1];
+    parse_word(type_name, "field type");
+    check_status();
+    field_type = vis_field_type_from_str(type_name);
+    if (field_type == VIS_INVALID) {
+        err("Unknown field type %s", type_name);
+        return;
+    }
+
+    expect(TOKEN_VERT_SEP, "'|'");
+    parse_word(field_name, "field name");
+    parse_description();
+    check_status();
+
+    for (size_t i = 0; i < struct_num; i++) {
+        if (!field_variations[i]) {
+            continue;
+        }
+        if (vis_find_field(structs[i], field_name)) {
+            err("Duplicate field %s", field_name);
+            return;
+        }
+        size_t size = field_sizes[field_size_num == 1 ? 0 : i];
+        vis_add_field(structs[i], field_name, size, field_type, description);
+    }
+}
+
+static void parse_struct_def()
+{
+    lex();
+    parse_word(struct_name, "structure name");
+    check_status();
+
+    struct_variation_num = 0;
+    if (is_keyword("OF")) {
+        lex();
+        do {
+            check_status();
+            if (struct_variation_num == MAX_VARIATIONS) {
+                err("Too many variations of structure %s", struct_name);
+                return;
+            }
+            parse_word(struct_variation_list[struct_variation_num++], "variation name");
+        } while (accept(TOKEN_COMMA));
+    }
+    check_status();
+
+    // Create all structures first: creation may move the ones created before
+    char name[2 * MAX_NAME_LEN + 3];
+    size_t struct_num = (struct_variation_num > 0) ? struct_variation_num : 1;
+    for (size_t i = 0; i < struct_num; i++) {
+        if (struct_variation_num > 0) {
+            variation_struct_name(name, sizeof(name), struct_name, struct_variation_list[i]);
+        } else {
+            strcpy_s(name, sizeof(name), struct_name);
+        }
+        if (vis_find_struct(name)) {
+            err("Duplicate structure %s", name);
+            return;
+        }
+        vis_create_struct(name);
+    }
+
+    vis_struct_t *structs[MAX_VARIATIONS];
+    for (size_t i = 0; i < struct_num; i++) {
+        if (struct_variation_num > 0) {
+            variation_struct_name(name, sizeof(name), struct_name, struct_variation_list[i]);
+        } else {
+            strcpy_s(name, sizeof(name), struct_name);
+        }
+        structs[i] = vis_find_struct(name);
+    }
+
+    expect(TOKEN_HORIZ_SEP, "separator line");
+    while (status && !is_token(TOKEN_HORIZ_SEP)) {
+        parse_field_variations();
+        check_status();
+        parse_field_row(structs, struct_num);
+    }
+    expect(TOKEN_HORIZ_SEP, "separator line");
+}
 
 
 /*
-** Parsing interface
+** Field definition
 */
 
-void parse_file(const char *fname)
+static void parse_value_rows(vis_field_t **fields, size_t field_num)
+{
+    expect(TOKEN_HORIZ_SEP, "separator line");
+    while (status && !is_token(TOKEN_HORIZ_SEP)) {
+        parse_word(value_name, "value name");
+        expect(TOKEN_VERT_SEP, "'|'");
+        parse_number(&value);
+        parse_description();
+        check_status();
+
+        for (size_t i = 0; i < field_num; i++) {
+            vis_add_value_info(fields[i], value_name, value, description);
+        }
+    }
+    expect(TOKEN_HORIZ_SEP, "separator line");
+}
+
+static void parse_field_def()
 {
-    fopen_s(&file, fname, "r");
+    char target_field[MAX_NAME_LEN + 1];
+    char variation[MAX_NAME_LEN + 1] = "";
+
+    lex();
+    parse_word(target_field, "field name");
+    expect_keyword("OF");
+    parse_word(struct_name, "structure name");
+    if (is_token(TOKEN_LEFT_BR)) {
+        lex();
+        parse_word(variation, "variation name");
+        expect(TOKEN_RIGHT_BR, "')'");
+    }
+    check_status();
+
+    // Field of a plain structure, of one variation, or of all variations
+    vis_field_t *fields[MAX_VARIATIONS];
+    size_t field_num = 0;
+    char name[2 * MAX_NAME_LEN + 3];
+    vis_struct_t *st = NULL;
+    if (variation[0]) {
+        variation_struct_name(name, sizeof(name), struct_name, variation);
+        st = vis_find_struct(name);
+    } else {
+        st = vis_find_struct(struct_name);
+    }
 
-    scan();
-    while (c != EOF) {
-        printf("%d:%d %s\n", line_number, sym_number, char_to_str(c));
-        scan();
+    if (st) {
+        fields[field_num] = vis_find_field(st, target_field);
+        field_num += (fields[field_num] != NULL);
+    } else if (!variation[0]) {
+        size_t prefix_len = sprintf_s(name, sizeof(name), "%s(", struct_name);
+        for (size_t i = 0; i < vis_struct_num() && field_num < MAX_VARIATIONS; i++) {
+            st = vis_get_struct(i);
+            if (strncmp(vis_str(st->name), name, prefix_len) == 0 &&
+                    (fields[field_num] = vis_find_field(st, target_field)) != NULL) {
+                field_num++;
+            }
+        }
     }
 
+    if (field_num == 0) {
+        err("Unknown field %s of structure %s", target_field, struct_name);
+        return;
+    }
 
-    //get_char();
+    parse_value_rows(fields, field_num);
+}
 
-    //parse_config();
 
-    //if (!status) {
-    //    fprintf(stderr, "Error parsing %s:\n%s", fname, error);
-    //}
+/*
+** Parsing interface
+*/
 
-    fclose(file);
+// Parse a petc file and add its structures to the schema
+bool parse_file(const char *fname)
+{
+    status = true;
+    error[0] = '\0';
+    struct_variation_num = 0;
+
+    if (!scanner_init(fname)) {
+        set_error("Failed to open petc file");
+        return false;
+    }
+    lexer_init();
+
+    while (status && !is_token(TOKEN_EOF)) {
+        if (is_keyword("STRUCT") || is_keyword("STRUCTURE")) {
+            parse_struct_def();
+        } else if (is_keyword("FIELD")) {
+            parse_field_def();
+        } else {
+            err("Expected STRUCT or FIELD, got %s", token_to_str(&token));
+        }
+    }
+
+    scanner_close();
+
+    if (!status) {
+        char msg[MAX_ERROR_LEN + 1];
+        sprintf_s(msg, MAX_ERROR_LEN + 1, "%s:%s", fname, error);
+        set_error(msg);
+    }
+    return status;
 }
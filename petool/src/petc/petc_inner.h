@@ -1,2 +1,135 @@
-#pragma once
+/**
+ * @file
+ *
+ * Internal interface of the petc schema compiler: scanner, lexer and parser
+ */
 
+#ifndef PETC_INNER_H
+#define PETC_INNER_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "../vis_struct.h"
+#include "../image.h"
+
+/*
+** Scanner: the whole source file in memory, and the current character
+*/
+
+typedef struct
+{
+    pe_image_t   file;
+    const char  *pos;           // current character
+    const char  *end;
+    const char  *line_start;    // first character of current line
+    unsigned int line;
+} scanner_t;
+
+extern scanner_t scanner;
+
+bool scanner_init(const char *fname);
+void scanner_close();
+
+static __inline int sym()
+{
+    return (scanner.pos < scanner.end) ? (unsigned char)*scanner.pos : EOF;
+}
+
+static __inline bool is_char(char ch)
+{
+    return (scanner.pos < scanner.end && *scanner.pos == ch);
+}
+
+static __inline bool is_letter()
+{
+    int c = sym();
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+}
+
+static __inline bool is_digit()
+{
+    int c = sym();
+    return (c >= '0' && c <= '9');
+}
+
+static __inline bool is_hex_digit()
+{
+    int c = sym();
+    return ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F'));
+}
+
+// CR of CRLF line ends is plain whitespace, lines are counted at LF
+static __inline bool is_ws()
+{
+    int c = sym();
+    return (c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r' || c == '\n');
+}
+
+static __inline bool is_eof()
+{
+    return (scanner.pos >= scanner.end);
+}
+
+static __inline void scan()
+{
+    if (scanner.pos < scanner.end) {
+        if (*scanner.pos == '\n') {
+            scanner.line++;
+            scanner.line_start = scanner.pos + 1;
+        }
+        scanner.pos++;
+    }
+}
+
+// Position of the current character, counted from 1
+static __inline unsigned int scanner_line()
+{
+    return scanner.line;
+}
+
+static __inline unsigned int scanner_column()
+{
+    return (unsigned int)(scanner.pos - scanner.line_start) + 1;
+}
+
+const char * char_to_str(int c);
+
+/*
+** Lexer: current token
+*/
+
+typedef enum
+{
+    TOKEN_NUMBER,
+    TOKEN_WORD,
+    TOKEN_STRING,
+    TOKEN_EOF,
+    TOKEN_COMMA,
+    TOKEN_HORIZ_SEP,
+    TOKEN_VERT_SEP,
+    TOKEN_LEFT_BR,
+    TOKEN_RIGHT_BR,
+    TOKEN_SLASH,
+
+    TOKEN_INVALID,
+} token_type_t;
+
+// Text of words and strings is a slice of the source. Whitespace inside a
+// string is kept as it is in the source.
+typedef struct
+{
+    token_type_t type;
+    vis_value_t value;          // TOKEN_NUMBER
+    const char *text;           // TOKEN_WORD, TOKEN_STRING
+    size_t len;
+} token_t;
+
+extern token_t token;
+extern unsigned int token_line;
+extern unsigned int token_column;
+
+void lexer_init();
+void lex();
+const char * token_to_str(const token_t *t);
+
+#endif
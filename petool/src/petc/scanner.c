@@ -1,68 +1,27 @@
 #include <stdio.h>
 #include <stdbool.h>
+#include "petc_inner.h"
 
-// Scanner state: file, character, and position
-static FILE *file = NULL;
-static int c = '\0';
-static unsigned int line_number = 1;
-static unsigned int sym_number = 0;
+// Scanner state: source file, current character, and line
+scanner_t scanner;
 
-void scanner_init(const char *fname)
+// Map or read the whole source file and start at its first character
+bool scanner_init(const char *fname)
 {
-    fopen_s(&file, fname, "r");
-
-}
-
-int sym()
-{
-    return c;
-}
-
-bool is_char(char ch)
-{
-    return (c == ch);
-}
-
-bool is_letter()
-{
-    return (c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z');
-}
-
-bool is_digit()
-{
-    return (c >= '0' && c <= '9');
-}
-
-bool is_ws()
-{
-    return (c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r' || c == '\n');
-}
-
-bool is_eof()
-{
-    return (c == EOF);
+    if (!image_open(&scanner.file, fname)) {
+        return false;
+    }
+    scanner.pos = (const char *)scanner.file.data;
+    scanner.end = scanner.pos + scanner.file.size;
+    scanner.line_start = scanner.pos;
+    scanner.line = 1;
+    return true;
 }
 
-void scan()
+void scanner_close()
 {
-    // Update line and symbol numbers for new character
-    if (c == '\n') {
-        line_number++;
-        sym_number = 0;
-    }
-    sym_number++;
-
-    // Get next character
-    c = getc(file);
-
-    // Convert all newlines to LF
-    if (c == '\r') {
-        c = getc(file);
-        if (c != '\n') {
-            fseek(file, -1, SEEK_CUR);
-        }
-        c = '\n';
-    }
+    image_close(&scanner.file);
+    scanner.pos = scanner.end = scanner.line_start = NULL;
 }
 
 const char * char_to_str(int c)
@@ -106,9 +65,9 @@ const char * char_to_str(int c)
     }
 
     if (c >= 33 && c <= 126) {
-        static char ch;
-        ch = c;
-        return &ch;
+        static char ch[2];
+        ch[0] = (char)c;
+        return ch;
     }
 
     static char buf[100];
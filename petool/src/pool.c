@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <SDL.h>
+#include "pool.h"
+#include "compat.h"
+
+#define DEQUE_INIT_CAP 64
+
+typedef struct
+{
+    pool_task_fn_t fn;
+    void *arg;
+} pool_task_t;
+
+// Task deque of a single worker: a ring buffer guarded by a spin lock. The
+// owner works at the bottom, thieves take from the top.
+typedef struct
+{
+    SDL_SpinLock lock;
+    pool_task_t *tasks;
+    size_t cap;
+    size_t top;
+    size_t count;
+} pool_deque_t;
+
+typedef struct
+{
+    pool_t *pool;
+    size_t idx;
+    SDL_Thread *thread;
+} pool_worker_t;
+
+struct pool_t
+{
+    size_t thread_num;
+    pool_worker_t *workers;
+    pool_deque_t *deques;
+
+    SDL_sem *available;         // one token per queued task
+    SDL_atomic_t pending;       // tasks queued or running
+    SDL_atomic_t next_deque;    // round-robin target for pushes from outside
+    SDL_atomic_t done;
+
+    SDL_mutex *idle_lock;
+    SDL_cond *idle;             // signaled when pending drops to zero
+};
+
+// Worker running on the current thread, NULL outside of pool threads
+static THREAD_LOCAL pool_worker_t *current_worker = NULL;
+
+static void _deque_push(pool_deque_t *deque, pool_task_t task)
+{
+    SDL_AtomicLock(&deque->lock);
+    if (deque->count == deque->cap) {
+        size_t new_cap = deque->cap * 2 + DEQUE_INIT_CAP;
+        pool_task_t *tasks = malloc(sizeof(pool_task_t) * new_cap);
+        for (size_t i = 0; i < deque->count; i++) {
+            tasks[i] = deque->tasks[(deque->top + i) % deque->cap];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->cap = new_cap;
+        deque->top = 0;
+    }
+    deque->tasks[(deque->top + deque->count) % deque->cap] = task;
+    deque->count++;
+    SDL_AtomicUnlock(&deque->lock);
+}
+
+static bool _deque_pop_bottom(pool_deque_t *deque, pool_task_t *task)
+{
+    bool found = false;
+    SDL_AtomicLock(&deque->lock);
+    if (deque->count > 0) {
+        deque->count--;
+        *task = deque->tasks[(deque->top + deque->count) % deque->cap];
+        found = true;
+    }
+    SDL_AtomicUnlock(&deque->lock);
+    return found;
+}
+
+static bool _deque_steal_top(pool_deque_t *deque, pool_task_t *task)
+{
+    bool found = false;
+    SDL_AtomicLock(&deque->lock);
+    if (deque->count > 0) {
+        *task = deque->tasks[deque->top];
+        deque->top = (deque->top + 1) % deque->cap;
+        deque->count--;
+        found = true;
+    }
+    SDL_AtomicUnlock(&deque->lock);
+    return found;
+}
+
+// Take a task: own deque first, then steal from the others
+static bool _take_task(pool_t *pool, size_t idx, pool_task_t *task)
+{
+    if (_deque_pop_bottom(&pool->deques[idx], task)) {
+        return true;
+    }
+    for (size_t i = 1; i < pool->thread_num; i++) {
+        if (_deque_steal_top(&pool->deques[(idx + i) % pool->thread_num], task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int _worker_main(void *data)
+{
+    pool_worker_t *worker = data;
+    pool_t *pool = worker->pool;
+    current_worker = worker;
+
+    for (;;) {
+        SDL_SemWait(pool->available);
+        if (SDL_AtomicGet(&pool->done)) {
+            break;
+        }
+
+        // Holding a token guarantees that a queued task exists somewhere
+        pool_task_t task;
+        while (!_take_task(pool, worker->idx, &task)) {
+            SDL_Delay(0);
+        }
+
+        task.fn(task.arg);
+
+        if (SDL_AtomicAdd(&pool->pending, -1) == 1) {
+            SDL_LockMutex(pool->idle_lock);
+            SDL_CondBroadcast(pool->idle);
+            SDL_UnlockMutex(pool->idle_lock);
+        }
+    }
+
+    return 0;
+}
+
+// Create a pool. If thread_num is 0, one thread per CPU core is used.
+pool_t * pool_create(size_t thread_num)
+{
+    if (thread_num == 0) {
+        thread_num = (size_t)SDL_GetCPUCount();
+    }
+
+    pool_t *pool = calloc(1, sizeof(pool_t));
+    pool->thread_num = thread_num;
+    pool->workers = calloc(thread_num, sizeof(pool_worker_t));
+    pool->deques = calloc(thread_num, sizeof(pool_deque_t));
+    pool->available = SDL_CreateSemaphore(0);
+    pool->idle_lock = SDL_CreateMutex();
+    pool->idle = SDL_CreateCond();
+    SDL_AtomicSet(&pool->pending, 0);
+    SDL_AtomicSet(&pool->next_deque, 0);
+    SDL_AtomicSet(&pool->done, 0);
+
+    for (size_t i = 0; i < thread_num; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].idx = i;
+        pool->workers[i].thread = SDL_CreateThread(_worker_main, "pool worker", &pool->workers[i]);
+    }
+
+    return pool;
+}
+
+// Stop all workers and release the pool. Queued tasks are not run.
+void pool_destroy(pool_t *pool)
+{
+    SDL_AtomicSet(&pool->done, 1);
+    for (size_t i = 0; i < pool->thread_num; i++) {
+        SDL_SemPost(pool->available);
+    }
+    for (size_t i = 0; i < pool->thread_num; i++) {
+        SDL_WaitThread(pool->workers[i].thread, NULL);
+    }
+
+    for (size_t i = 0; i < pool->thread_num; i++) {
+        free(pool->deques[i].tasks);
+    }
+    SDL_DestroyCond(pool->idle);
+    SDL_DestroyMutex(pool->idle_lock);
+    SDL_DestroySemaphore(pool->available);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t pool_thread_num(const pool_t *pool)
+{
+    return pool->thread_num;
+}
+
+// Queue a task. Tasks queued by a worker go to its own deque, others are
+// spread over all deques.
+void pool_push(pool_t *pool, pool_task_fn_t fn, void *arg)
+{
+    pool_task_t task = { fn, arg };
+
+    size_t idx;
+    if (current_worker && current_worker->pool == pool) {
+        idx = current_worker->idx;
+    } else {
+        idx = (size_t)(unsigned int)SDL_AtomicAdd(&pool->next_deque, 1) % pool->thread_num;
+    }
+
+    SDL_AtomicAdd(&pool->pending, 1);
+    _deque_push(&pool->deques[idx], task);
+    SDL_SemPost(pool->available);
+}
+
+// Wait until all queued tasks, including the ones they queue, are finished.
+// Must not be called from a pool thread.
+void pool_wait(pool_t *pool)
+{
+    SDL_LockMutex(pool->idle_lock);
+    while (SDL_AtomicGet(&pool->pending) > 0) {
+        SDL_CondWait(pool->idle, pool->idle_lock);
+    }
+    SDL_UnlockMutex(pool->idle_lock);
+}
@@ -0,0 +1,26 @@
+/**
+ * @file
+ *
+ * Work-stealing thread pool. Every worker owns a task deque: it pushes and
+ * pops its own tasks at the bottom and steals from the top of other workers'
+ * deques when its own runs dry. Tasks may push more tasks.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+typedef void (*pool_task_fn_t)(void *arg);
+
+typedef struct pool_t pool_t;
+
+pool_t * pool_create(size_t thread_num);
+void pool_destroy(pool_t *pool);
+
+size_t pool_thread_num(const pool_t *pool);
+
+void pool_push(pool_t *pool, pool_task_fn_t fn, void *arg);
+void pool_wait(pool_t *pool);
+
+#endif
@@ -0,0 +1,232 @@
+#include <stdlib.h>
+#include <string.h>
+#include "resource_table.h"
+#include "error.h"
+#include "compat.h"
+
+#define RESOURCE_HIGH_BIT 0x80000000u
+
+static uint32_t _load_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static uint16_t _load_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Check if size bytes at offset lie within the resource table
+static bool _has(const resource_table_t *table, uint32_t offset, size_t size)
+{
+    return (offset <= table->size && size <= table->size - offset);
+}
+
+// Locate the resource table. Fails without an error set if the image has no
+// resource directory.
+bool read_resource_table(const pe_headers_t *pe, resource_table_t *table)
+{
+    memset(table, 0, sizeof(resource_table_t));
+    table->pe = pe;
+
+    data_directory_t dd;
+    if (!pe_data_dir(pe, DATA_DIR_RESOURCE_TABLE, &dd)) {
+        return false;
+    }
+
+    // Only the directory structures are read through the table, so it is
+    // enough that they are backed by the file; leaf data is found by RVA
+    const rva_interval_t *iv = rva_find_interval(&pe->sections, dd.VirtualAddress);
+    if (!iv || dd.VirtualAddress >= iv->file_end) {
+        set_error("Resource directory is out of image");
+        return false;
+    }
+    size_t size = (size_t)(iv->file_end - dd.VirtualAddress);
+    if (dd.Size < size) {
+        size = dd.Size;
+    }
+    table->rva = dd.VirtualAddress;
+    table->size = size;
+    table->data = rva_ptr(pe->image, &pe->sections, dd.VirtualAddress, size);
+    if (!table->data) {
+        set_error("Resource directory is out of image");
+        return false;
+    }
+    return true;
+}
+
+// Decode a directory table header; its entries are decoded on access
+bool resource_open_dir(const resource_table_t *table, uint32_t offset, resource_dir_t *dir)
+{
+    if (!_has(table, offset, RESOURCE_DIRECTORY_SIZE)) {
+        set_error("Resource directory table is out of resource section");
+        return false;
+    }
+    memcpy(&dir->dir, table->data + offset, RESOURCE_DIRECTORY_SIZE);
+    dir->table = table;
+    dir->offset = offset;
+    dir->entry_num = (size_t)dir->dir.NumberOfNameEntries + dir->dir.NumberOfIdEntries;
+    if (!_has(table, offset + RESOURCE_DIRECTORY_SIZE, dir->entry_num * RESOURCE_ENTRY_SIZE)) {
+        set_error("Resource directory entries are out of resource section");
+        return false;
+    }
+    return true;
+}
+
+// Decode an entry of an opened directory
+bool resource_dir_entry(const resource_dir_t *dir, size_t idx, resource_entry_t *entry)
+{
+    const resource_table_t *table = dir->table;
+    const uint8_t *p = table->data + dir->offset + RESOURCE_DIRECTORY_SIZE + idx * RESOURCE_ENTRY_SIZE;
+    uint32_t name = _load_u32(p);
+    uint32_t target = _load_u32(p + 4);
+
+    entry->is_dir = (target & RESOURCE_HIGH_BIT) != 0;
+    entry->offset = target & ~RESOURCE_HIGH_BIT;
+
+    entry->name.is_id = (name & RESOURCE_HIGH_BIT) == 0;
+    if (entry->name.is_id) {
+        entry->name.id = name;
+        entry->name.utf16 = NULL;
+        entry->name.len = 0;
+        return true;
+    }
+
+    // Resource Directory String: 2-byte length in code units, then UTF-16LE
+    uint32_t str_offset = name & ~RESOURCE_HIGH_BIT;
+    if (!_has(table, str_offset, 2)) {
+        set_error("Resource name is out of resource section");
+        return false;
+    }
+    entry->name.id = 0;
+    entry->name.len = _load_u16(table->data + str_offset);
+    entry->name.utf16 = table->data + str_offset + 2;
+    if (!_has(table, str_offset + 2, 2 * entry->name.len)) {
+        set_error("Resource name is out of resource section");
+        return false;
+    }
+    return true;
+}
+
+// Add a directory offset to the visited set, false if it is there already
+static bool _visit(resource_iter_t *it, uint32_t offset)
+{
+    if (2 * (it->visited_num + 1) > it->visited_cap) {
+        size_t old_cap = it->visited_cap;
+        uint32_t *old = it->visited;
+        it->visited_cap = old_cap ? 2 * old_cap : 64;
+        it->visited = calloc(it->visited_cap, sizeof(uint32_t));
+        it->visited_num = 0;
+        for (size_t i = 0; i < old_cap; i++) {
+            if (old[i]) {
+                _visit(it, old[i] - 1);
+            }
+        }
+        free(old);
+    }
+
+    // Directory offsets are multiples of 4, so the low bits of the product
+    // are mostly zero. Take the slot from its high bits instead.
+    size_t mask = it->visited_cap - 1;
+    size_t pos = (uint32_t)(offset * 0x9E3779B1u) >> (32 - bit_index(it->visited_cap));
+    while (it->visited[pos]) {
+        if (it->visited[pos] == offset + 1) {
+            return false;
+        }
+        pos = (pos + 1) & mask;
+    }
+    it->visited[pos] = offset + 1;
+    it->visited_num++;
+    return true;
+}
+
+// Stop iteration with an error
+static bool _fail(resource_iter_t *it, const char *msg)
+{
+    if (msg) {
+        set_error(msg);
+    }
+    it->depth = 0;
+    return false;
+}
+
+// Start walking the leaves of a resource tree from the root directory
+bool resource_iter_init(resource_iter_t *it, const resource_table_t *table)
+{
+    memset(it, 0, sizeof(resource_iter_t));
+    it->table = table;
+    if (!resource_open_dir(table, 0, &it->dirs[0])) {
+        return false;
+    }
+    _visit(it, 0);
+    it->depth = 1;
+    return true;
+}
+
+// Get the next leaf in depth-first order, opening directories on the way.
+// Returns false after the last leaf, and also with an error set if the tree
+// is damaged or too deep; the walk does not continue past damage.
+bool resource_next_leaf(resource_iter_t *it, resource_leaf_t *leaf)
+{
+    const resource_table_t *table = it->table;
+    while (it->depth > 0) {
+        size_t level = it->depth - 1;
+        if (it->next[level] >= it->dirs[level].entry_num) {
+            it->depth--;
+            continue;
+        }
+
+        resource_entry_t entry;
+        if (!resource_dir_entry(&it->dirs[level], it->next[level]++, &entry)) {
+            return _fail(it, NULL);
+        }
+        it->names[level] = entry.name;
+
+        if (entry.is_dir) {
+            if (it->depth == RESOURCE_MAX_DEPTH) {
+                return _fail(it, "Resource tree is too deep");
+            }
+            // A directory reached again is not expanded again. This breaks
+            // cycles, and a shared subtree yields its leaves only once.
+            if (!_visit(it, entry.offset)) {
+                continue;
+            }
+            if (!resource_open_dir(table, entry.offset, &it->dirs[it->depth])) {
+                return _fail(it, NULL);
+            }
+            it->next[it->depth] = 0;
+            it->depth++;
+            continue;
+        }
+
+        if (!_has(table, entry.offset, RESOURCE_DATA_ENTRY_SIZE)) {
+            return _fail(it, "Resource data entry is out of resource section");
+        }
+        const uint8_t *p = table->data + entry.offset;
+        const pe_headers_t *pe = table->pe;
+        leaf->rva = _load_u32(p);
+        leaf->size = _load_u32(p + 4);
+        leaf->codepage = _load_u32(p + 8);
+        leaf->data = rva_ptr(pe->image, &pe->sections, leaf->rva, leaf->size);
+        leaf->offset = leaf->data ? (size_t)(leaf->data - pe->image->data) : 0;
+
+        // Levels of the usual tree: type, name, language
+        resource_name_t none = { true, 0, NULL, 0 };
+        leaf->depth = it->depth;
+        leaf->type = (it->depth > 0) ? it->names[0] : none;
+        leaf->name = (it->depth > 1) ? it->names[1] : none;
+        leaf->lang = (it->depth > 2) ? it->names[2] : none;
+        return true;
+    }
+    return false;
+}
+
+void resource_iter_free(resource_iter_t *it)
+{
+    free(it->visited);
+    it->visited = NULL;
+    it->visited_cap = 0;
+    it->visited_num = 0;
+}
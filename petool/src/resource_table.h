@@ -0,0 +1,108 @@
+/**
+ * @file
+ *
+ * Resource tree decoder. A directory is decoded only when it is opened, names
+ * are views of the UTF-16 strings in the image, and leaves are streamed by
+ * an iterator that never copies resource data. Every directory is expanded at
+ * most once per traversal, so malformed trees with shared or cyclic
+ * subdirectories cannot make it loop.
+ */
+
+#ifndef RESOURCE_TABLE_H
+#define RESOURCE_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+
+#define RESOURCE_DIRECTORY_SIZE 16
+#define RESOURCE_ENTRY_SIZE 8
+#define RESOURCE_DATA_ENTRY_SIZE 16
+
+// Deepest directory level the leaf iterator descends to; the usual tree has
+// type, name and language levels
+#define RESOURCE_MAX_DEPTH 8
+
+// Resource Directory Table
+typedef struct {
+    uint32_t Characteristics;
+    uint32_t TimeDateStamp;
+    uint16_t MajorVersion;
+    uint16_t MinorVersion;
+    uint16_t NumberOfNameEntries;
+    uint16_t NumberOfIdEntries;
+} resource_directory_t;
+
+// Name of a directory entry: an integer ID or a UTF-16LE string
+typedef struct
+{
+    bool           is_id;
+    uint32_t       id;
+    const uint8_t *utf16;           // unaligned UTF-16LE code units, not NUL-terminated
+    size_t         len;             // number of code units
+} resource_name_t;
+
+// Resource section located by the data directory
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            rva;        // start of the resource data directory
+    const uint8_t      *data;       // file data of the whole directory
+    size_t              size;
+} resource_table_t;
+
+// Opened directory
+typedef struct
+{
+    const resource_table_t *table;
+    uint32_t                offset; // from the start of the resource table
+    resource_directory_t    dir;
+    size_t                  entry_num;
+} resource_dir_t;
+
+// Entry of a directory, pointing to a subdirectory or to data
+typedef struct
+{
+    resource_name_t name;
+    bool            is_dir;
+    uint32_t        offset;         // of subdirectory or data entry, from start of the resource table
+} resource_entry_t;
+
+// Leaf of the tree with the names along its path
+typedef struct
+{
+    resource_name_t type;
+    resource_name_t name;
+    resource_name_t lang;
+    size_t          depth;          // number of directories above the leaf
+    uint32_t        rva;
+    uint32_t        size;
+    uint32_t        codepage;
+    const uint8_t  *data;           // NULL if the data is not backed by the file
+    size_t          offset;         // file offset of data, if any
+} resource_leaf_t;
+
+// Depth-first walk over the leaves of the tree
+typedef struct
+{
+    const resource_table_t *table;
+    resource_dir_t          dirs[RESOURCE_MAX_DEPTH];
+    size_t                  next[RESOURCE_MAX_DEPTH];
+    resource_name_t         names[RESOURCE_MAX_DEPTH];
+    size_t                  depth;  // number of open directories
+    uint32_t               *visited;// hash set of expanded directory offsets + 1
+    size_t                  visited_cap;
+    size_t                  visited_num;
+} resource_iter_t;
+
+bool read_resource_table(const pe_headers_t *pe, resource_table_t *table);
+bool resource_open_dir(const resource_table_t *table, uint32_t offset, resource_dir_t *dir);
+bool resource_dir_entry(const resource_dir_t *dir, size_t idx, resource_entry_t *entry);
+
+bool resource_iter_init(resource_iter_t *it, const resource_table_t *table);
+bool resource_next_leaf(resource_iter_t *it, resource_leaf_t *leaf);
+void resource_iter_free(resource_iter_t *it);
+
+#endif
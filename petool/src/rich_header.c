@@ -0,0 +1,110 @@
+#include <string.h>
+#include "rich_header.h"
+#include "error.h"
+
+#define DOS_HEADER_SIZE      0x40
+#define PE_OFFSET_FIELD      0x3C
+#define RICH_ENTRY_SIZE      8
+#define RICH_PADDING_SIZE    12     // three masked zeros after "DanS"
+
+#define FNV64_OFFSET_BASIS   0xCBF29CE484222325ull
+#define FNV64_PRIME          0x100000001B3ull
+
+static uint32_t _load_u32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static uint32_t _rol32(uint32_t value, unsigned shift)
+{
+    shift &= 31;
+    return shift ? (value << shift) | (value >> (32 - shift)) : value;
+}
+
+// The key is a checksum of the header offset, the bytes before the Rich
+// header except the PE offset field, and the entries rotated by their counts
+static uint32_t _rich_checksum(const uint8_t *data, const rich_header_t *rich)
+{
+    uint32_t sum = (uint32_t)rich->offset;
+    for (size_t i = 0; i < rich->offset; i++) {
+        if (i >= PE_OFFSET_FIELD && i < PE_OFFSET_FIELD + 4) {
+            continue;
+        }
+        sum += _rol32(data[i], (unsigned)i);
+    }
+    for (size_t i = 0; i < rich->entry_num; i++) {
+        rich_entry_t entry;
+        rich_entry_at(rich, i, &entry);
+        sum += _rol32(((uint32_t)entry.product << 16) | entry.build, entry.count);
+    }
+    return sum;
+}
+
+// Find and unmask the Rich header. Fails without an error set if the image
+// has none.
+bool read_rich_header(const pe_image_t *image, rich_header_t *rich)
+{
+    memset(rich, 0, sizeof(rich_header_t));
+
+    uint32_t pe_offset;
+    if (!image_read_u32(image, PE_OFFSET_FIELD, &pe_offset)) {
+        return false;
+    }
+    if (pe_offset > image->size) {
+        pe_offset = (uint32_t)image->size;
+    }
+
+    // "Rich" and the key end the header; it is dword-aligned
+    const uint8_t *data = image->data;
+    size_t rich_offset = 0;
+    for (size_t pos = (pe_offset & ~3u); pos >= DOS_HEADER_SIZE + 8; pos -= 4) {
+        if (_load_u32(data + pos - 8) == RICH_SIGNATURE) {
+            rich_offset = pos - 8;
+            break;
+        }
+    }
+    if (rich_offset == 0) {
+        return false;
+    }
+    rich->key = _load_u32(data + rich_offset + 4);
+
+    size_t pos = rich_offset;
+    while (pos >= DOS_HEADER_SIZE + 4 && (_load_u32(data + pos - 4) ^ rich->key) != RICH_DANS) {
+        pos -= 4;
+    }
+    if (pos < DOS_HEADER_SIZE + 4) {
+        set_error("Rich header has no start");
+        return false;
+    }
+    rich->offset = pos - 4;
+    if (rich_offset - pos < RICH_PADDING_SIZE || (rich_offset - pos - RICH_PADDING_SIZE) % RICH_ENTRY_SIZE) {
+        set_error("Invalid Rich header size");
+        return false;
+    }
+    rich->entries = data + pos + RICH_PADDING_SIZE;
+    rich->entry_num = (rich_offset - pos - RICH_PADDING_SIZE) / RICH_ENTRY_SIZE;
+
+    uint64_t hash = FNV64_OFFSET_BASIS;
+    for (size_t i = 0; i < rich->entry_num; i++) {
+        uint32_t comp_id = _load_u32(rich->entries + i * RICH_ENTRY_SIZE) ^ rich->key;
+        for (unsigned b = 0; b < 32; b += 8) {
+            hash ^= (uint8_t)(comp_id >> b);
+            hash *= FNV64_PRIME;
+        }
+    }
+    rich->fingerprint = hash;
+    rich->checksum_valid = (_rich_checksum(data, rich) == rich->key);
+    return true;
+}
+
+// Unmask an entry
+void rich_entry_at(const rich_header_t *rich, size_t idx, rich_entry_t *entry)
+{
+    const uint8_t *p = rich->entries + idx * RICH_ENTRY_SIZE;
+    uint32_t comp_id = _load_u32(p) ^ rich->key;
+    entry->product = (uint16_t)(comp_id >> 16);
+    entry->build = (uint16_t)comp_id;
+    entry->count = _load_u32(p + 4) ^ rich->key;
+}
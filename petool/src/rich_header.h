@@ -0,0 +1,43 @@
+/**
+ * @file
+ *
+ * Rich header decoder. The linker stores a masked list of the tools that
+ * built the image between the MS-DOS stub and the PE signature. The header
+ * is found in the mapped image and unmasked in place, so decoding it adds no
+ * reads to the header pass.
+ */
+
+#ifndef RICH_HEADER_H
+#define RICH_HEADER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+
+#define RICH_SIGNATURE 0x68636952   // "Rich"
+#define RICH_DANS      0x536E6144   // "DanS", masked like the entries
+
+// Tool that contributed objects to the image
+typedef struct
+{
+    uint16_t product;           // product id of the tool
+    uint16_t build;             // build number of the tool
+    uint32_t count;             // number of objects it produced
+} rich_entry_t;
+
+// Located Rich header
+typedef struct
+{
+    size_t         offset;          // file offset of "DanS"
+    uint32_t       key;             // XOR mask, also the checksum
+    bool           checksum_valid;  // key matches the DOS header and entries
+    const uint8_t *entries;         // entry_num masked 8-byte entries
+    size_t         entry_num;
+    uint64_t       fingerprint;     // hash of the tools, ignoring object counts
+} rich_header_t;
+
+bool read_rich_header(const pe_image_t *image, rich_header_t *rich);
+void rich_entry_at(const rich_header_t *rich, size_t idx, rich_entry_t *entry);
+
+#endif
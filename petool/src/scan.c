@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <SDL.h>
+#include "scan.h"
+#include "pool.h"
+#include "image.h"
+#include "error.h"
+#include "pe_signature.h"
+#include "coff_header.h"
+#include "pe_headers.h"
+#include "import_table.h"
+#include "debug_dir.h"
+#include "cert_table.h"
+#include "rich_header.h"
+#include "checksum.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define PATH_SEP "\\"
+#else
+#include <dirent.h>
+#include <limits.h>
+#include <sys/stat.h>
+#define PATH_SEP "/"
+#endif
+
+#define MAX_LINE_LEN 1024
+
+// Limits that keep directory columns within one line
+#define MAX_PDB_PATH_LEN 260
+#define MAX_LISTED_CERTS 8
+#define MAX_DLL_NAME_LEN 64
+#define DEPS_RESERVED_LEN 128
+
+// State shared by all scan tasks
+typedef struct
+{
+    pool_t *pool;
+    SDL_mutex *output_lock;
+    SDL_atomic_t file_num;
+    SDL_atomic_t image_num;
+    SDL_atomic_t error_num;
+    SDL_atomic_t bad_checksum_num;
+    const char *import_dll;     // DLL to look for in imports, or NULL
+    const char *import_func;    // function to look for, NULL for any
+    bool pdb;                   // print PDB identity
+    bool certs;                 // print certificate types
+    bool deps;                  // print imported and delay-loaded DLLs
+    bool rich;                  // print toolchain fingerprint from the Rich header
+    bool verify_checksum;       // compute the image checksum and compare it to CheckSum
+} scan_t;
+
+// Argument of a scan task: file or directory to scan
+typedef struct
+{
+    scan_t *scan;
+    char path[];
+} scan_task_t;
+
+static void _scan_file(void *arg);
+static void _scan_dir(void *arg);
+
+static void _push_path(scan_t *scan, const char *dir, const char *name, pool_task_fn_t fn)
+{
+    size_t dir_len = dir ? strlen(dir) + strlen(PATH_SEP) : 0;
+    size_t path_size = dir_len + strlen(name) + 1;
+    scan_task_t *task = malloc(sizeof(scan_task_t) + path_size);
+    task->scan = scan;
+    sprintf_s(task->path, path_size, "%s%s%s", dir ? dir : "", dir ? PATH_SEP : "", name);
+    pool_push(scan->pool, fn, task);
+}
+
+// Write one output line. Lines of concurrent tasks do not interleave, and each
+// one starts with the file path, so output can be sorted afterwards.
+static void _output(scan_t *scan, const char *path, const char *line)
+{
+    SDL_LockMutex(scan->output_lock);
+    printf("%s\t%s\n", path, line);
+    SDL_UnlockMutex(scan->output_lock);
+}
+
+// Append a DLL name to the dependency list. Once the line is full, the list
+// ends with "..." and room is left for an error message.
+static int _append_dep(char *line, size_t size, int len, const char *prefix, image_str_t name, size_t *dep_num)
+{
+    int name_len = (name.len < MAX_DLL_NAME_LEN) ? (int)name.len : MAX_DLL_NAME_LEN;
+    if (*dep_num == SIZE_MAX) {
+        return len;
+    }
+    if ((size_t)len + strlen(prefix) + name_len + DEPS_RESERVED_LEN >= size) {
+        *dep_num = SIZE_MAX;
+        return len + sprintf_s(line + len, size - len, ",...");
+    }
+    len += sprintf_s(line + len, size - len, "%s%s%.*s", *dep_num ? "," : "", prefix, name_len, name.str);
+    (*dep_num)++;
+    return len;
+}
+
+// Append columns that need the data directories: whether the image imports
+// the function given on the command line, its PDB identity, certificates and
+// the DLLs it depends on
+static void _scan_directories(scan_t *scan, const pe_image_t *image, char *line, size_t size)
+{
+    pe_headers_t pe;
+    if (!read_pe_headers(image, &pe)) {
+        SDL_AtomicAdd(&scan->error_num, 1);
+        sprintf_s(line, size, " error: %s", get_error());
+        pe_headers_free(&pe);
+        return;
+    }
+
+    int len = 0;
+    if (scan->import_dll) {
+        bool found = import_find(&pe, scan->import_dll, scan->import_func);
+        if (has_error()) {
+            SDL_AtomicAdd(&scan->error_num, 1);
+            len += sprintf_s(line + len, size - len, " import=error: %s", get_error());
+        } else {
+            len += sprintf_s(line + len, size - len, " import=%s", found ? "yes" : "no");
+        }
+        clear_error();
+    }
+    if (scan->pdb) {
+        codeview_t cv;
+        char key[CODEVIEW_KEY_SIZE];
+        if (find_codeview(&pe, &cv)) {
+            codeview_key(&cv, key);
+            int path_len = (cv.pdb_path.len < MAX_PDB_PATH_LEN) ? (int)cv.pdb_path.len : MAX_PDB_PATH_LEN;
+            len += sprintf_s(line + len, size - len, " pdb=%s %.*s", key, path_len, cv.pdb_path.str);
+        } else if (has_error()) {
+            SDL_AtomicAdd(&scan->error_num, 1);
+            len += sprintf_s(line + len, size - len, " pdb=error: %s", get_error());
+        } else {
+            len += sprintf_s(line + len, size - len, " pdb=none");
+        }
+        clear_error();
+    }
+    if (scan->certs) {
+        cert_iter_t it;
+        cert_entry_t cert;
+        cert_iter_init(&it, &pe);
+        len += sprintf_s(line + len, size - len, " certs=");
+        size_t cert_num = 0;
+        while (cert_next_entry(&it, &cert)) {
+            if (cert_num < MAX_LISTED_CERTS) {
+                len += sprintf_s(line + len, size - len, "%s0x%x:%u", cert_num ? "," : "", cert.type, (unsigned int)cert.size);
+            } else if (cert_num == MAX_LISTED_CERTS) {
+                len += sprintf_s(line + len, size - len, ",...");
+            }
+            cert_num++;
+        }
+        if (has_error()) {
+            SDL_AtomicAdd(&scan->error_num, 1);
+            len += sprintf_s(line + len, size - len, "%serror: %s", cert_num ? "," : "", get_error());
+        } else if (cert_num == 0) {
+            len += sprintf_s(line + len, size - len, "none");
+        }
+        clear_error();
+    }
+    if (scan->deps) {
+        // Delay-loaded DLLs are part of the dependency graph too, so both
+        // tables are listed in the same pass
+        size_t dep_num = 0;
+        import_iter_t it;
+        import_dll_t dll;
+        delay_import_dll_t delay_dll;
+        len += sprintf_s(line + len, size - len, " deps=");
+        import_iter_init(&it, &pe);
+        while (import_next_dll(&it, &dll)) {
+            len = _append_dep(line, size, len, "", dll.name, &dep_num);
+        }
+        if (!has_error()) {
+            delay_import_iter_init(&it, &pe);
+            while (delay_import_next_dll(&it, &delay_dll)) {
+                len = _append_dep(line, size, len, "delay:", delay_dll.name, &dep_num);
+            }
+        }
+        if (has_error()) {
+            SDL_AtomicAdd(&scan->error_num, 1);
+            len += sprintf_s(line + len, size - len, "%serror: %s", dep_num ? "," : "", get_error());
+        } else if (dep_num == 0) {
+            len += sprintf_s(line + len, size - len, "none");
+        }
+        clear_error();
+    }
+    pe_headers_free(&pe);
+}
+
+// Decode headers of a single file
+static void _scan_file(void *arg)
+{
+    scan_task_t *task = arg;
+    scan_t *scan = task->scan;
+    char line[MAX_LINE_LEN + 1];
+
+    SDL_AtomicAdd(&scan->file_num, 1);
+    clear_error();
+
+    pe_image_t image;
+    if (!image_open(&image, task->path)) {
+        SDL_AtomicAdd(&scan->error_num, 1);
+        sprintf_s(line, MAX_LINE_LEN + 1, "error: %s", get_error());
+        _output(scan, task->path, line);
+        free(task);
+        return;
+    }
+
+    // Skip anything that does not start as an MS-DOS stub
+    if (image.size < 2 || image.data[0] != 'M' || image.data[1] != 'Z') {
+        image_close(&image);
+        free(task);
+        return;
+    }
+    SDL_AtomicAdd(&scan->image_num, 1);
+
+    size_t coff_offset;
+    coff_file_header_t coff;
+    uint16_t magic = 0;
+    if (read_pe_signature(&image, &coff_offset) && read_coff_file_header(&image, coff_offset, &coff) &&
+            (coff.SizeOfOptionalHeader == 0 || image_read_u16(&image, coff_offset + COFF_FILE_HEADER_SIZE, &magic))) {
+        int len = sprintf_s(line, MAX_LINE_LEN + 1, "machine=0x%04x sections=%u magic=0x%03x characteristics=0x%04x",
+            coff.Machine, coff.NumberOfSections, magic, coff.Characteristics);
+        if (scan->rich) {
+            rich_header_t rich;
+            if (read_rich_header(&image, &rich)) {
+                len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " rich=%016llx/%u%s", (unsigned long long)rich.fingerprint,
+                    (unsigned int)rich.entry_num, rich.checksum_valid ? "" : "/bad-checksum");
+            } else if (has_error()) {
+                SDL_AtomicAdd(&scan->error_num, 1);
+                len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " rich=error: %s", get_error());
+                clear_error();
+            } else {
+                len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " rich=none");
+            }
+        }
+        if (scan->verify_checksum && coff.SizeOfOptionalHeader != 0) {
+            pe_checksum_t checksum;
+            if (read_pe_checksum(&image, coff_offset + COFF_FILE_HEADER_SIZE, coff.SizeOfOptionalHeader, &checksum)) {
+                if (checksum.stored == 0) {
+                    len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " checksum=unset computed=0x%08x", checksum.computed);
+                } else if (checksum.stored == checksum.computed) {
+                    len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " checksum=ok");
+                } else {
+                    SDL_AtomicAdd(&scan->bad_checksum_num, 1);
+                    len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " checksum=bad stored=0x%08x computed=0x%08x",
+                        checksum.stored, checksum.computed);
+                }
+            } else {
+                SDL_AtomicAdd(&scan->error_num, 1);
+                len += sprintf_s(line + len, MAX_LINE_LEN + 1 - len, " checksum=error: %s", get_error());
+                clear_error();
+            }
+        }
+        if (scan->import_dll || scan->pdb || scan->certs || scan->deps) {
+            _scan_directories(scan, &image, line + len, MAX_LINE_LEN + 1 - len);
+        }
+    } else {
+        SDL_AtomicAdd(&scan->error_num, 1);
+        sprintf_s(line, MAX_LINE_LEN + 1, "error: %s", get_error());
+    }
+    _output(scan, task->path, line);
+
+    image_close(&image);
+    free(task);
+}
+
+// Queue all files and subdirectories of a directory
+static void _scan_dir(void *arg)
+{
+    scan_task_t *task = arg;
+    scan_t *scan = task->scan;
+
+#ifdef _WIN32
+    // Paths of any length are listed, or fail as this directory only
+    size_t pattern_size = strlen(task->path) + 3;
+    char *pattern = malloc(pattern_size);
+    sprintf_s(pattern, pattern_size, "%s\\*", task->path);
+
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    free(pattern);
+    if (find == INVALID_HANDLE_VALUE) {
+        SDL_AtomicAdd(&scan->error_num, 1);
+        _output(scan, task->path, "error: Failed to list directory");
+        free(task);
+        return;
+    }
+
+    do {
+        if (strcmp(entry.cFileName, ".") == 0 || strcmp(entry.cFileName, "..") == 0) {
+            continue;
+        }
+        // Do not follow junctions and symbolic links, they may form cycles
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+            continue;
+        }
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            _push_path(scan, task->path, entry.cFileName, _scan_dir);
+        } else {
+            _push_path(scan, task->path, entry.cFileName, _scan_file);
+        }
+    } while (FindNextFileA(find, &entry));
+
+    FindClose(find);
+#else
+    DIR *dir = opendir(task->path);
+    if (!dir) {
+        SDL_AtomicAdd(&scan->error_num, 1);
+        _output(scan, task->path, "error: Failed to list directory");
+        free(task);
+        return;
+    }
+
+    // Entry paths are built in one buffer that fits the longest name, so
+    // deep paths are never truncated
+    size_t path_size = strlen(task->path) + 1 + NAME_MAX + 1;
+    char *path = malloc(path_size);
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        // Do not follow symbolic links, they may form cycles
+        snprintf(path, path_size, "%s/%s", task->path, entry->d_name);
+        struct stat st;
+        if (lstat(path, &st)) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            _push_path(scan, task->path, entry->d_name, _scan_dir);
+        } else if (S_ISREG(st.st_mode)) {
+            _push_path(scan, task->path, entry->d_name, _scan_file);
+        }
+    }
+
+    free(path);
+    closedir(dir);
+#endif
+
+    free(task);
+}
+
+static bool _is_dir(const char *path)
+{
+#ifdef _WIN32
+    DWORD attrs = GetFileAttributesA(path);
+    return (attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY));
+#else
+    struct stat st;
+    return (stat(path, &st) == 0 && S_ISDIR(st.st_mode));
+#endif
+}
+
+// Entry point of "petool scan [-j threads] [-i dll[!function]] [-p] [-c] [-d] [-r] [--verify-checksum] <path>..."
+int scan_main(int argc, char *argv[])
+{
+    scan_t scan;
+    scan.import_dll = NULL;
+    scan.import_func = NULL;
+    scan.pdb = false;
+    scan.certs = false;
+    scan.deps = false;
+    scan.rich = false;
+    scan.verify_checksum = false;
+
+    size_t thread_num = 0;
+    int first_path = 0;
+    while (first_path < argc) {
+        if (strcmp(argv[first_path], "-p") == 0 || strcmp(argv[first_path], "-c") == 0 ||
+                strcmp(argv[first_path], "-d") == 0 || strcmp(argv[first_path], "-r") == 0) {
+            scan.pdb |= (argv[first_path][1] == 'p');
+            scan.certs |= (argv[first_path][1] == 'c');
+            scan.deps |= (argv[first_path][1] == 'd');
+            scan.rich |= (argv[first_path][1] == 'r');
+            first_path++;
+            continue;
+        }
+        if (strcmp(argv[first_path], "--verify-checksum") == 0) {
+            scan.verify_checksum = true;
+            first_path++;
+            continue;
+        }
+        if (first_path + 1 >= argc) {
+            break;
+        }
+        if (strcmp(argv[first_path], "-j") == 0) {
+            thread_num = (size_t)strtoul(argv[first_path + 1], NULL, 10);
+        } else if (strcmp(argv[first_path], "-i") == 0) {
+            char *sep = strchr(argv[first_path + 1], '!');
+            if (sep) {
+                *sep = '\0';
+                scan.import_func = sep + 1;
+            }
+            scan.import_dll = argv[first_path + 1];
+        } else {
+            break;
+        }
+        first_path += 2;
+    }
+
+    if (first_path >= argc) {
+        fprintf(stderr, "Usage: petool scan [-j threads] [-i dll[!function]] [-p] [-c] [-d] [-r] [--verify-checksum] <path>...\n");
+        return 1;
+    }
+
+    scan.pool = pool_create(thread_num);
+    scan.output_lock = SDL_CreateMutex();
+    SDL_AtomicSet(&scan.file_num, 0);
+    SDL_AtomicSet(&scan.image_num, 0);
+    SDL_AtomicSet(&scan.error_num, 0);
+    SDL_AtomicSet(&scan.bad_checksum_num, 0);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int i = first_path; i < argc; i++) {
+        _push_path(&scan, NULL, argv[i], _is_dir(argv[i]) ? _scan_dir : _scan_file);
+    }
+    pool_wait(scan.pool);
+
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    int file_num = SDL_AtomicGet(&scan.file_num);
+    fprintf(stderr, "Scanned %d files (%d images, %d errors) in %.3f s with %u threads, %.0f files/s\n",
+        file_num, SDL_AtomicGet(&scan.image_num), SDL_AtomicGet(&scan.error_num), seconds,
+        (unsigned int)pool_thread_num(scan.pool), seconds > 0 ? file_num / seconds : 0.0);
+    if (scan.verify_checksum) {
+        fprintf(stderr, "%d images with a bad checksum\n", SDL_AtomicGet(&scan.bad_checksum_num));
+    }
+
+    pool_destroy(scan.pool);
+    SDL_DestroyMutex(scan.output_lock);
+
+    return (SDL_AtomicGet(&scan.error_num) == 0 && SDL_AtomicGet(&scan.bad_checksum_num) == 0) ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+/**
+ * @file
+ *
+ * Corpus scanner: walks directory trees and decodes headers of every file
+ * concurrently on a thread pool
+ */
+
+#ifndef SCAN_H
+#define SCAN_H
+
+int scan_main(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,468 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "schema_cache.h"
+#include "vis_struct.h"
+#include "image.h"
+#include "error.h"
+#include "petc.h"
+#include "codegen.h"
+
+
+#define SCHEMA_CACHE_MAGIC "PETCSCHM"
+#define SCHEMA_CACHE_ALIGN 8
+
+/*
+** Cache layout. All offsets are from the start of the blob and all sections
+** are aligned to SCHEMA_CACHE_ALIGN, so that records can be used in place.
+*/
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t source_num;
+    uint32_t struct_num;
+    uint32_t field_num;
+    uint64_t sources;               // cache_source_t[source_num]
+    uint64_t structs;               // cache_struct_t[struct_num]
+    uint64_t fields;                // cache_field_t[field_num], grouped by structure
+    uint64_t strings;               // string arena characters
+    uint64_t strings_size;
+    uint64_t string_index;          // name_index_entry_t[string_index_cap]
+    uint64_t string_index_cap;
+    uint64_t string_index_size;
+    uint64_t struct_index;          // name_index_entry_t[struct_index_cap]
+    uint64_t struct_index_cap;
+} cache_header_t;
+
+typedef struct
+{
+    uint64_t size;
+    uint32_t hash;                  // FNV-1a of the contents
+    uint32_t reserved;
+    uint64_t path;                  // NUL-terminated path
+    uint64_t path_len;
+} cache_source_t;
+
+typedef struct
+{
+    str_ref_t name;
+    uint64_t  size;
+    uint32_t  first_field;
+    uint32_t  field_num;
+    uint64_t  field_index;          // name_index_entry_t[field_index_cap]
+    uint64_t  field_index_cap;
+} cache_struct_t;
+
+typedef struct
+{
+    str_ref_t name;
+    str_ref_t description;
+    uint64_t  offset;
+    uint64_t  size;
+    uint32_t  type;
+    uint32_t  value_num;
+    uint64_t  values;               // vis_value_info_t[value_num]
+    uint64_t  value_order;          // uint32_t[value_num]
+    uint64_t  flag_first;           // uint32_t[VIS_FLAG_BUCKETS + 1], FLAG fields only
+} cache_field_t;
+
+// Cache a loaded schema is mapped from; stays open for the lifetime of the schema
+static pe_image_t cache_image;
+
+// Size and content hash of a file. Unlike a modification time, the hash
+// catches edits that keep the size within the same second, and survives
+// checkouts that only touch the time.
+static bool _file_stamp(const char *fname, uint32_t *hash, uint64_t *size)
+{
+    pe_image_t image;
+    if (!image_open(&image, fname)) {
+        return false;
+    }
+    *hash = name_hash((const char *)image.data, image.size);
+    *size = (uint64_t)image.size;
+    image_close(&image);
+    return true;
+}
+
+
+/*
+** Writing
+*/
+
+// Append data to blob at an aligned position. Returns its offset.
+static uint64_t _put(store_t *blob, const void *data, size_t size)
+{
+    size_t pad = (SCHEMA_CACHE_ALIGN - blob->size % SCHEMA_CACHE_ALIGN) % SCHEMA_CACHE_ALIGN;
+    uint8_t *dest = store_alloc_n(blob, pad + size);
+    memset(dest, 0, pad);
+    if (size) {
+        memcpy(dest + pad, data, size);
+    }
+    return (uint64_t)(blob->size - size);
+}
+
+static uint64_t _put_index(store_t *blob, const name_index_t *index)
+{
+    return _put(blob, index->entries, index->cap * sizeof(name_index_entry_t));
+}
+
+// Write current schema into a cache file, stamped with its source files
+bool schema_cache_write(const char *fname, const char **sources, size_t source_num)
+{
+    const vis_schema_t *schema = vis_schema();
+    store_t blob = store_init(uint8_t);
+    cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    _put(&blob, &header, sizeof(header));
+
+    // Source stamps
+    cache_source_t *cs = calloc(source_num ? source_num : 1, sizeof(cache_source_t));
+    for (size_t i = 0; i < source_num; i++) {
+        if (!_file_stamp(sources[i], &cs[i].hash, &cs[i].size)) {
+            free(cs);
+            free(blob.data);
+            set_error("Failed to read schema source file");
+            return false;
+        }
+        cs[i].path_len = strlen(sources[i]);
+        cs[i].path = _put(&blob, sources[i], (size_t)cs[i].path_len + 1);
+    }
+    header.sources = _put(&blob, cs, source_num * sizeof(cache_source_t));
+    header.source_num = (uint32_t)source_num;
+    free(cs);
+
+    // Strings and structure index
+    header.strings = _put(&blob, schema->strings.chars.data, schema->strings.chars.size);
+    header.strings_size = schema->strings.chars.size;
+    header.string_index = _put_index(&blob, &schema->strings.index);
+    header.string_index_cap = schema->strings.index.cap;
+    header.string_index_size = schema->strings.index.size;
+    header.struct_index = _put_index(&blob, &schema->struct_index);
+    header.struct_index_cap = schema->struct_index.cap;
+
+    // Value tables of every field, then field and structure records
+    store_t fields = store_init(cache_field_t);
+    store_t structs = store_init(cache_struct_t);
+    for (size_t i = 0; i < schema->structs.size; i++) {
+        const vis_struct_t *st = store_pget(&schema->structs, i);
+        cache_struct_t *cst = store_alloc(&structs);
+        cst->name = st->name;
+        cst->size = st->size;
+        cst->first_field = (uint32_t)fields.size;
+        cst->field_num = (uint32_t)st->fields.size;
+        cst->field_index = _put_index(&blob, &st->field_index);
+        cst->field_index_cap = st->field_index.cap;
+
+        for (size_t j = 0; j < st->fields.size; j++) {
+            const vis_field_t *field = store_pget(&st->fields, j);
+            cache_field_t *cf = store_alloc(&fields);
+            memset(cf, 0, sizeof(cache_field_t));
+            cf->name = field->name;
+            cf->description = field->description;
+            cf->offset = field->offset;
+            cf->size = field->size;
+            cf->type = (uint32_t)field->type;
+            cf->value_num = (uint32_t)field->valid_values.size;
+            cf->values = _put(&blob, field->valid_values.data, field->valid_values.size * sizeof(vis_value_info_t));
+            cf->value_order = _put(&blob, field->value_order.data, field->value_order.size * sizeof(uint32_t));
+            if (field->flag_first.size == VIS_FLAG_BUCKETS + 1) {
+                cf->flag_first = _put(&blob, field->flag_first.data, field->flag_first.size * sizeof(uint32_t));
+            }
+        }
+    }
+    header.fields = _put(&blob, fields.data, fields.size * sizeof(cache_field_t));
+    header.field_num = (uint32_t)fields.size;
+    header.structs = _put(&blob, structs.data, structs.size * sizeof(cache_struct_t));
+    header.struct_num = (uint32_t)structs.size;
+    free(fields.data);
+    free(structs.data);
+
+    memcpy(header.magic, SCHEMA_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SCHEMA_CACHE_VERSION;
+    memcpy(blob.data, &header, sizeof(header));
+
+    FILE *outfile = NULL;
+    if (fopen_s(&outfile, fname, "wb")) {
+        free(blob.data);
+        set_error("Failed to create schema cache file");
+        return false;
+    }
+    bool ok = (fwrite(blob.data, 1, blob.size, outfile) == blob.size);
+    ok = (fclose(outfile) == 0) && ok;
+    free(blob.data);
+
+    if (!ok) {
+        set_error("Failed to write schema cache file");
+    }
+    return ok;
+}
+
+
+/*
+** Loading
+*/
+
+static bool _check_ref(const cache_header_t *header, str_ref_t ref)
+{
+    return ((uint64_t)ref.offset + ref.len < header->strings_size);
+}
+
+static bool _check_index(const pe_image_t *image, uint64_t offset, uint64_t cap, size_t count)
+{
+    if (cap > image->size) {
+        return false;
+    }
+    const name_index_entry_t *entries = image_ptr(image, (size_t)offset, (size_t)cap * sizeof(name_index_entry_t));
+    if (cap > 0 && (!entries || (cap & (cap - 1)) != 0)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < cap; i++) {
+        if (entries[i].idx > count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Check that every record of a mapped cache is in range and its sources are up to date
+static bool _check_cache(const pe_image_t *image)
+{
+    const cache_header_t *header = image_ptr(image, 0, sizeof(cache_header_t));
+    if (!header || memcmp(header->magic, SCHEMA_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+            header->version != SCHEMA_CACHE_VERSION) {
+        set_error("Not a schema cache of this version");
+        return false;
+    }
+
+    const cache_source_t *sources = image_ptr(image, (size_t)header->sources, header->source_num * sizeof(cache_source_t));
+    const cache_struct_t *structs = image_ptr(image, (size_t)header->structs, header->struct_num * sizeof(cache_struct_t));
+    const cache_field_t *fields = image_ptr(image, (size_t)header->fields, header->field_num * sizeof(cache_field_t));
+    const char *strings = image_ptr(image, (size_t)header->strings, (size_t)header->strings_size);
+    if (!sources || !structs || !fields || !strings ||
+            !_check_index(image, header->string_index, header->string_index_cap, (size_t)header->strings_size) ||
+            !_check_index(image, header->struct_index, header->struct_index_cap, header->struct_num)) {
+        set_error("Schema cache is damaged");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header->source_num; i++) {
+        const char *path = image_ptr(image, (size_t)sources[i].path, (size_t)sources[i].path_len + 1);
+        uint32_t hash;
+        uint64_t size;
+        if (!path || path[sources[i].path_len] != '\0') {
+            set_error("Schema cache is damaged");
+            return false;
+        }
+        if (!_file_stamp(path, &hash, &size) || hash != sources[i].hash || size != sources[i].size) {
+            set_error("Schema cache is out of date");
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->struct_num; i++) {
+        const cache_struct_t *cst = &structs[i];
+        if (!_check_ref(header, cst->name) || (uint64_t)cst->first_field + cst->field_num > header->field_num ||
+                !_check_index(image, cst->field_index, cst->field_index_cap, cst->field_num)) {
+            set_error("Schema cache is damaged");
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->field_num; i++) {
+        const cache_field_t *cf = &fields[i];
+        const vis_value_info_t *values = image_ptr(image, (size_t)cf->values, cf->value_num * sizeof(vis_value_info_t));
+        const uint32_t *order = image_ptr(image, (size_t)cf->value_order, cf->value_num * sizeof(uint32_t));
+        const uint32_t *first = image_ptr(image, (size_t)cf->flag_first, (VIS_FLAG_BUCKETS + 1) * sizeof(uint32_t));
+        if (!_check_ref(header, cf->name) || !_check_ref(header, cf->description) || cf->type >= VIS_INVALID ||
+                !values || !order || (cf->flag_first && (!first || first[VIS_FLAG_BUCKETS] != cf->value_num))) {
+            set_error("Schema cache is damaged");
+            return false;
+        }
+        for (uint32_t k = 0; k < cf->value_num; k++) {
+            if (order[k] >= cf->value_num || !_check_ref(header, values[k].name) ||
+                    !_check_ref(header, values[k].description)) {
+                set_error("Schema cache is damaged");
+                return false;
+            }
+        }
+        for (uint32_t b = 0; cf->flag_first && b < VIS_FLAG_BUCKETS; b++) {
+            if (first[b] > first[b + 1]) {
+                set_error("Schema cache is damaged");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Store referring to records of the mapped cache. With no capacity of its own
+// it is copied to the heap before it grows.
+static store_t _mapped_store(const pe_image_t *image, uint64_t offset, size_t elsize, size_t size)
+{
+    store_t store = { (void *)image_ptr(image, (size_t)offset, elsize * size), elsize, size, 0 };
+    return store;
+}
+
+static name_index_t _mapped_index(const pe_image_t *image, uint64_t offset, uint64_t cap, size_t size)
+{
+    name_index_t index = { (name_index_entry_t *)image_ptr(image, (size_t)offset, (size_t)cap * sizeof(name_index_entry_t)), (size_t)cap, size, true };
+    return index;
+}
+
+// Check that the cache was compiled from exactly these sources, in order
+static bool _check_sources(const pe_image_t *image, const char **sources, size_t source_num)
+{
+    const cache_header_t *header = image_ptr(image, 0, sizeof(cache_header_t));
+    const cache_source_t *cached = image_ptr(image, (size_t)header->sources, header->source_num * sizeof(cache_source_t));
+    if (header->source_num != source_num) {
+        set_error("Schema cache was compiled from other sources");
+        return false;
+    }
+    for (size_t i = 0; i < source_num; i++) {
+        const char *path = image_ptr(image, (size_t)cached[i].path, (size_t)cached[i].path_len + 1);
+        if (strcmp(path, sources[i]) != 0) {
+            set_error("Schema cache was compiled from other sources");
+            return false;
+        }
+    }
+    return true;
+}
+
+// Map a cache file and point the schema at it. With sources given, the cache
+// must also have been compiled from them.
+static bool _load_cache(const char *fname, const char **sources, size_t source_num)
+{
+    vis_schema_t *schema = vis_schema();
+    if (schema->structs.size > 0) {
+        set_error("Schema is already loaded");
+        return false;
+    }
+
+    pe_image_t image;
+    if (!image_open(&image, fname)) {
+        return false;
+    }
+    if (!_check_cache(&image) || (sources && !_check_sources(&image, sources, source_num))) {
+        image_close(&image);
+        return false;
+    }
+
+    const cache_header_t *header = image_ptr(&image, 0, sizeof(cache_header_t));
+    const cache_struct_t *structs = image_ptr(&image, (size_t)header->structs, header->struct_num * sizeof(cache_struct_t));
+    const cache_field_t *fields = image_ptr(&image, (size_t)header->fields, header->field_num * sizeof(cache_field_t));
+
+    schema->strings.chars = _mapped_store(&image, header->strings, 1, (size_t)header->strings_size);
+    schema->strings.index = _mapped_index(&image, header->string_index, header->string_index_cap, (size_t)header->string_index_size);
+    schema->struct_index = _mapped_index(&image, header->struct_index, header->struct_index_cap, header->struct_num);
+
+    // Only structure and field records are rebuilt, everything else stays in the mapping
+    vis_struct_t *st = store_alloc_n(&schema->structs, header->struct_num);
+    for (uint32_t i = 0; i < header->struct_num; i++, st++) {
+        const cache_struct_t *cst = &structs[i];
+        st->name = cst->name;
+        st->size = (size_t)cst->size;
+        st->field_index = _mapped_index(&image, cst->field_index, cst->field_index_cap, cst->field_num);
+        st->decode = NULL;
+        store_create(&st->fields, vis_field_t);
+
+        vis_field_t *field = store_alloc_n(&st->fields, cst->field_num);
+        for (uint32_t j = 0; j < cst->field_num; j++, field++) {
+            const cache_field_t *cf = &fields[cst->first_field + j];
+            field->index = j;
+            field->offset = (size_t)cf->offset;
+            field->size = (size_t)cf->size;
+            field->type = (vis_field_type_t)cf->type;
+            field->name = cf->name;
+            field->description = cf->description;
+            field->value_name = NULL;
+            field->flag_names = NULL;
+            field->valid_values = _mapped_store(&image, cf->values, sizeof(vis_value_info_t), cf->value_num);
+            field->value_order = _mapped_store(&image, cf->value_order, sizeof(uint32_t), cf->value_num);
+            field->flag_first = cf->flag_first ?
+                _mapped_store(&image, cf->flag_first, sizeof(uint32_t), VIS_FLAG_BUCKETS + 1) :
+                _mapped_store(&image, 0, sizeof(uint32_t), 0);
+        }
+    }
+
+    cache_image = image;
+    return true;
+}
+
+// Load the schema from a cache file. Fails if the cache is missing, damaged,
+// or its sources have changed, or if a schema is already loaded.
+bool schema_cache_load(const char *fname)
+{
+    return _load_cache(fname, NULL, 0);
+}
+
+// Load the schema from cache if it is up to date and was compiled from these
+// sources, otherwise parse the sources and write a new cache for the next start
+bool schema_load(const char *cache_fname, const char **sources, size_t source_num)
+{
+    if (_load_cache(cache_fname, sources, source_num)) {
+        return true;
+    }
+    clear_error();
+
+    for (size_t i = 0; i < source_num; i++) {
+        if (!parse_file(sources[i])) {
+            return false;
+        }
+    }
+
+    // Failing to write the cache only costs parsing time on the next start
+    if (!schema_cache_write(cache_fname, sources, source_num)) {
+        clear_error();
+    }
+    return true;
+}
+
+// Entry point of "petool schema compile|print|codegen ..."
+int schema_main(int argc, char *argv[])
+{
+    if (argc >= 3 && strcmp(argv[0], "compile") == 0) {
+        for (int i = 2; i < argc; i++) {
+            if (!parse_file(argv[i])) {
+                fprintf(stderr, "%s\n", get_error());
+                return 1;
+            }
+        }
+        if (!schema_cache_write(argv[1], (const char **)(argv + 2), (size_t)(argc - 2))) {
+            fprintf(stderr, "%s: %s\n", argv[1], get_error());
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc == 2 && strcmp(argv[0], "print") == 0) {
+        if (!schema_cache_load(argv[1])) {
+            fprintf(stderr, "%s: %s\n", argv[1], get_error());
+            return 1;
+        }
+        vis_print_all();
+        return 0;
+    }
+
+    if (argc >= 4 && strcmp(argv[0], "codegen") == 0) {
+        for (int i = 3; i < argc; i++) {
+            if (!parse_file(argv[i])) {
+                fprintf(stderr, "%s\n", get_error());
+                return 1;
+            }
+        }
+        if (!codegen_write(argv[1], argv[2])) {
+            fprintf(stderr, "%s\n", get_error());
+            return 1;
+        }
+        return 0;
+    }
+
+    fprintf(stderr, "Usage: petool schema compile <cache> <petc>...\n"
+                    "       petool schema print <cache>\n"
+                    "       petool schema codegen <source.c> <header.h> <petc>...\n");
+    return 1;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file
+ *
+ * Binary schema cache. Compiled petc schemas are written as one relocatable
+ * blob, which is later mapped into memory and used in place: string arena,
+ * value tables, lookup orders and hash indices are all read from the mapping,
+ * only structure and field records are fixed up on load.
+ *
+ * The cache records size and FNV-1a content hash of every source file and is
+ * rejected as soon as one of them changes.
+ */
+
+#ifndef SCHEMA_CACHE_H
+#define SCHEMA_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SCHEMA_CACHE_VERSION 2
+
+bool schema_cache_write(const char *fname, const char **sources, size_t source_num);
+bool schema_cache_load(const char *fname);
+
+bool schema_load(const char *cache_fname, const char **sources, size_t source_num);
+
+int schema_main(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,1535 @@
+// Generated from petc schemas by "petool schema codegen". Do not edit.
+
+#include <string.h>
+#include "schema_gen.h"
+#include "error.h"
+
+typedef struct
+{
+    const char *name;
+    size_t offset;
+    size_t size;
+    vis_value_name_fn_t value_name;
+    vis_flag_names_fn_t flag_names;
+} schema_field_layout_t;
+
+typedef struct
+{
+    const char *name;
+    size_t size;
+    size_t field_num;
+    const schema_field_layout_t *fields;
+    vis_decode_fn_t decode;
+} schema_struct_layout_t;
+
+static __inline vis_value_t _load_u8(const uint8_t *p)
+{
+    uint8_t v;
+    memcpy(&v, p, 1);
+    return v;
+}
+
+static __inline vis_value_t _load_u16(const uint8_t *p)
+{
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return v;
+}
+
+static __inline vis_value_t _load_u32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static __inline vis_value_t _load_u64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+bool schema_read_coff_file_header(const pe_image_t *image, size_t offset, schema_coff_file_header_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 20);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->Machine, data + 0, 2);
+    memcpy(&record->NumberOfSections, data + 2, 2);
+    memcpy(&record->TimeDateStamp, data + 4, 4);
+    memcpy(&record->PointerToSymbolTable, data + 8, 4);
+    memcpy(&record->NumberOfSymbols, data + 12, 4);
+    memcpy(&record->SizeOfOptionalHeader, data + 16, 2);
+    memcpy(&record->Characteristics, data + 18, 2);
+    return true;
+}
+
+static void _decode_coff_file_header(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u16(data + 0);
+    values[1] = _load_u16(data + 2);
+    values[2] = _load_u32(data + 4);
+    values[3] = _load_u32(data + 8);
+    values[4] = _load_u32(data + 12);
+    values[5] = _load_u16(data + 16);
+    values[6] = _load_u16(data + 18);
+}
+
+static const schema_field_layout_t _layout_coff_file_header[] = {
+    { "Machine", 0, 2, schema_coff_file_header_machine_name, NULL },
+    { "NumberOfSections", 2, 2, NULL, NULL },
+    { "TimeDateStamp", 4, 4, NULL, NULL },
+    { "PointerToSymbolTable", 8, 4, NULL, NULL },
+    { "NumberOfSymbols", 12, 4, NULL, NULL },
+    { "SizeOfOptionalHeader", 16, 2, NULL, NULL },
+    { "Characteristics", 18, 2, NULL, schema_coff_file_header_characteristics_flags },
+};
+
+const char * schema_coff_file_header_machine_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_FILE_MACHINE_UNKNOWN";
+        case 0x184: return "IMAGE_FILE_MACHINE_ALPHA";
+        case 0x284: return "IMAGE_FILE_MACHINE_ALPHA64";
+        case 0x1d3: return "IMAGE_FILE_MACHINE_AM33";
+        case 0x8664: return "IMAGE_FILE_MACHINE_AMD64";
+        case 0x1c0: return "IMAGE_FILE_MACHINE_ARM";
+        case 0x1c4: return "IMAGE_FILE_MACHINE_ARMNT";
+        case 0xaa64: return "IMAGE_FILE_MACHINE_ARM64";
+        case 0xc0ee: return "IMAGE_FILE_MACHINE_CEE";
+        case 0xcef: return "IMAGE_FILE_MACHINE_CEF";
+        case 0xebc: return "IMAGE_FILE_MACHINE_EBC";
+        case 0x14c: return "IMAGE_FILE_MACHINE_I386";
+        case 0x200: return "IMAGE_FILE_MACHINE_IA64";
+        case 0x9041: return "IMAGE_FILE_MACHINE_M32R";
+        case 0x266: return "IMAGE_FILE_MACHINE_MIPS16";
+        case 0x366: return "IMAGE_FILE_MACHINE_MIPSFPU";
+        case 0x466: return "IMAGE_FILE_MACHINE_MIPSFPU16";
+        case 0x1f0: return "IMAGE_FILE_MACHINE_POWERPC";
+        case 0x1f1: return "IMAGE_FILE_MACHINE_POWERPCFP";
+        case 0x168: return "IMAGE_FILE_MACHINE_R10000";
+        case 0x162: return "IMAGE_FILE_MACHINE_R3000";
+        case 0x166: return "IMAGE_FILE_MACHINE_R4000";
+        case 0x1a2: return "IMAGE_FILE_MACHINE_SH3";
+        case 0x1a3: return "IMAGE_FILE_MACHINE_SH3DSP";
+        case 0x1a4: return "IMAGE_FILE_MACHINE_SH3E";
+        case 0x1a6: return "IMAGE_FILE_MACHINE_SH4";
+        case 0x1a8: return "IMAGE_FILE_MACHINE_SH5";
+        case 0x1c2: return "IMAGE_FILE_MACHINE_THUMB";
+        case 0x520: return "IMAGE_FILE_MACHINE_TRICORE";
+        case 0x169: return "IMAGE_FILE_MACHINE_WCEMIPSV2";
+    }
+    return NULL;
+}
+
+size_t schema_coff_file_header_characteristics_flags(vis_value_t value, char *buffer, size_t size)
+{
+    size_t pos = 0;
+    for (vis_value_t bits = value; bits; bits &= bits - 1) {
+        switch (bits & (~bits + 1))
+        {
+            case 0x1: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_RELOCS_STRIPPED "); break;
+            case 0x2: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_EXECUTABLE_IMAGE "); break;
+            case 0x4: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_LINE_NUMS_STRIPPED "); break;
+            case 0x8: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_LOCAL_SYMS_STRIPPED "); break;
+            case 0x10: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_AGGRESIVE_WS_TRIM "); break;
+            case 0x20: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_LARGE_ADDRESS_AWARE "); break;
+            case 0x80: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_BYTES_REVERSED_LO "); break;
+            case 0x100: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_32BIT_MACHINE "); break;
+            case 0x200: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_DEBUG_STRIPPED "); break;
+            case 0x400: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_REMOVABLE_RUN_FROM_SWAP "); break;
+            case 0x800: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_NET_RUN_FROM_SWAP "); break;
+            case 0x1000: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_SYSTEM "); break;
+            case 0x2000: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_DLL "); break;
+            case 0x4000: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_UP_SYSTEM_ONLY "); break;
+            case 0x8000: pos = vis_append_str(buffer, size, pos, "IMAGE_FILE_BYTES_REVERSED_HI "); break;
+        }
+    }
+    if (pos == 0 && size > 0) {
+        buffer[0] = '\0';
+    }
+    return pos;
+}
+
+bool schema_read_optional_header_pe32(const pe_image_t *image, size_t offset, schema_optional_header_pe32_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 96);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->Magic, data + 0, 2);
+    memcpy(&record->MajorLinkerVersion, data + 2, 1);
+    memcpy(&record->MinorLinkerVersion, data + 3, 1);
+    memcpy(&record->SizeOfCode, data + 4, 4);
+    memcpy(&record->SizeOfInitializedData, data + 8, 4);
+    memcpy(&record->SizeOfUninitializedData, data + 12, 4);
+    memcpy(&record->AddressOfEntryPoint, data + 16, 4);
+    memcpy(&record->BaseOfCode, data + 20, 4);
+    memcpy(&record->BaseOfData, data + 24, 4);
+    memcpy(&record->ImageBase, data + 28, 4);
+    memcpy(&record->SectionAlignment, data + 32, 4);
+    memcpy(&record->FileAlignment, data + 36, 4);
+    memcpy(&record->MajorOperatingSystemVersion, data + 40, 2);
+    memcpy(&record->MinorOperatingSystemVersion, data + 42, 2);
+    memcpy(&record->MajorImageVersion, data + 44, 2);
+    memcpy(&record->MinorImageVersion, data + 46, 2);
+    memcpy(&record->MajorSubsystemVersion, data + 48, 2);
+    memcpy(&record->MinorSubsystemVersion, data + 50, 2);
+    memcpy(&record->Win32VersionValue, data + 52, 4);
+    memcpy(&record->SizeOfImage, data + 56, 4);
+    memcpy(&record->SizeOfHeaders, data + 60, 4);
+    memcpy(&record->CheckSum, data + 64, 4);
+    memcpy(&record->Subsystem, data + 68, 2);
+    memcpy(&record->DllCharacteristics, data + 70, 2);
+    memcpy(&record->SizeOfStackReserve, data + 72, 4);
+    memcpy(&record->SizeOfStackCommit, data + 76, 4);
+    memcpy(&record->SizeOfHeapReserve, data + 80, 4);
+    memcpy(&record->SizeOfHeapCommit, data + 84, 4);
+    memcpy(&record->LoaderFlags, data + 88, 4);
+    memcpy(&record->NumberOfRvaAndSizes, data + 92, 4);
+    return true;
+}
+
+static void _decode_optional_header_pe32(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u16(data + 0);
+    values[1] = _load_u8(data + 2);
+    values[2] = _load_u8(data + 3);
+    values[3] = _load_u32(data + 4);
+    values[4] = _load_u32(data + 8);
+    values[5] = _load_u32(data + 12);
+    values[6] = _load_u32(data + 16);
+    values[7] = _load_u32(data + 20);
+    values[8] = _load_u32(data + 24);
+    values[9] = _load_u32(data + 28);
+    values[10] = _load_u32(data + 32);
+    values[11] = _load_u32(data + 36);
+    values[12] = _load_u16(data + 40);
+    values[13] = _load_u16(data + 42);
+    values[14] = _load_u16(data + 44);
+    values[15] = _load_u16(data + 46);
+    values[16] = _load_u16(data + 48);
+    values[17] = _load_u16(data + 50);
+    values[18] = _load_u32(data + 52);
+    values[19] = _load_u32(data + 56);
+    values[20] = _load_u32(data + 60);
+    values[21] = _load_u32(data + 64);
+    values[22] = _load_u16(data + 68);
+    values[23] = _load_u16(data + 70);
+    values[24] = _load_u32(data + 72);
+    values[25] = _load_u32(data + 76);
+    values[26] = _load_u32(data + 80);
+    values[27] = _load_u32(data + 84);
+    values[28] = _load_u32(data + 88);
+    values[29] = _load_u32(data + 92);
+}
+
+static const schema_field_layout_t _layout_optional_header_pe32[] = {
+    { "Magic", 0, 2, NULL, NULL },
+    { "MajorLinkerVersion", 2, 1, NULL, NULL },
+    { "MinorLinkerVersion", 3, 1, NULL, NULL },
+    { "SizeOfCode", 4, 4, NULL, NULL },
+    { "SizeOfInitializedData", 8, 4, NULL, NULL },
+    { "SizeOfUninitializedData", 12, 4, NULL, NULL },
+    { "AddressOfEntryPoint", 16, 4, NULL, NULL },
+    { "BaseOfCode", 20, 4, NULL, NULL },
+    { "BaseOfData", 24, 4, NULL, NULL },
+    { "ImageBase", 28, 4, NULL, NULL },
+    { "SectionAlignment", 32, 4, NULL, NULL },
+    { "FileAlignment", 36, 4, NULL, NULL },
+    { "MajorOperatingSystemVersion", 40, 2, NULL, NULL },
+    { "MinorOperatingSystemVersion", 42, 2, NULL, NULL },
+    { "MajorImageVersion", 44, 2, NULL, NULL },
+    { "MinorImageVersion", 46, 2, NULL, NULL },
+    { "MajorSubsystemVersion", 48, 2, NULL, NULL },
+    { "MinorSubsystemVersion", 50, 2, NULL, NULL },
+    { "Win32VersionValue", 52, 4, NULL, NULL },
+    { "SizeOfImage", 56, 4, NULL, NULL },
+    { "SizeOfHeaders", 60, 4, NULL, NULL },
+    { "CheckSum", 64, 4, NULL, NULL },
+    { "Subsystem", 68, 2, NULL, NULL },
+    { "DllCharacteristics", 70, 2, NULL, NULL },
+    { "SizeOfStackReserve", 72, 4, NULL, NULL },
+    { "SizeOfStackCommit", 76, 4, NULL, NULL },
+    { "SizeOfHeapReserve", 80, 4, NULL, NULL },
+    { "SizeOfHeapCommit", 84, 4, NULL, NULL },
+    { "LoaderFlags", 88, 4, NULL, NULL },
+    { "NumberOfRvaAndSizes", 92, 4, NULL, NULL },
+};
+
+const char * schema_optional_header_pe32_subsystem_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_SUBSYSTEM_UNKNOWN";
+        case 0x1: return "IMAGE_SUBSYSTEM_NATIVE";
+        case 0x2: return "IMAGE_SUBSYSTEM_WINDOWS_GUI";
+        case 0x3: return "IMAGE_SUBSYSTEM_WINDOWS_CUI";
+        case 0x7: return "IMAGE_SUBSYSTEM_POSIX_CUI";
+        case 0x9: return "IMAGE_SUBSYSTEM_WINDOWS_CE_GUI";
+        case 0xa: return "IMAGE_SUBSYSTEM_EFI_APPLICATION";
+        case 0xb: return "IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER";
+        case 0xc: return "IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER";
+        case 0xd: return "IMAGE_SUBSYSTEM_EFI_ROM";
+        case 0xe: return "IMAGE_SUBSYSTEM_XBOX";
+    }
+    return NULL;
+}
+
+const char * schema_optional_header_pe32_dll_characteristics_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x40: return "IMAGE_DLL_CHARACTERISTICS_DYNAMIC_BASE";
+        case 0x80: return "IMAGE_DLL_CHARACTERISTICS_FORCE_INTEGRITY";
+        case 0x100: return "IMAGE_DLL_CHARACTERISTICS_NX_COMPAT";
+        case 0x200: return "IMAGE_DLLCHARACTERISTICS_NO_ISOLATION";
+        case 0x400: return "IMAGE_DLLCHARACTERISTICS_NO_SEH";
+        case 0x800: return "IMAGE_DLLCHARACTERISTICS_NO_BIND";
+        case 0x2000: return "IMAGE_DLLCHARACTERISTICS_WDM_DRIVER";
+        case 0x8000: return "IMAGE_DLLCHARACTERISTICS_TERMINAL_SERVER_AWARE";
+    }
+    return NULL;
+}
+
+bool schema_read_optional_header_pe32_plus(const pe_image_t *image, size_t offset, schema_optional_header_pe32_plus_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 112);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->Magic, data + 0, 2);
+    memcpy(&record->MajorLinkerVersion, data + 2, 1);
+    memcpy(&record->MinorLinkerVersion, data + 3, 1);
+    memcpy(&record->SizeOfCode, data + 4, 4);
+    memcpy(&record->SizeOfInitializedData, data + 8, 4);
+    memcpy(&record->SizeOfUninitializedData, data + 12, 4);
+    memcpy(&record->AddressOfEntryPoint, data + 16, 4);
+    memcpy(&record->BaseOfCode, data + 20, 4);
+    memcpy(&record->ImageBase, data + 24, 8);
+    memcpy(&record->SectionAlignment, data + 32, 4);
+    memcpy(&record->FileAlignment, data + 36, 4);
+    memcpy(&record->MajorOperatingSystemVersion, data + 40, 2);
+    memcpy(&record->MinorOperatingSystemVersion, data + 42, 2);
+    memcpy(&record->MajorImageVersion, data + 44, 2);
+    memcpy(&record->MinorImageVersion, data + 46, 2);
+    memcpy(&record->MajorSubsystemVersion, data + 48, 2);
+    memcpy(&record->MinorSubsystemVersion, data + 50, 2);
+    memcpy(&record->Win32VersionValue, data + 52, 4);
+    memcpy(&record->SizeOfImage, data + 56, 4);
+    memcpy(&record->SizeOfHeaders, data + 60, 4);
+    memcpy(&record->CheckSum, data + 64, 4);
+    memcpy(&record->Subsystem, data + 68, 2);
+    memcpy(&record->DllCharacteristics, data + 70, 2);
+    memcpy(&record->SizeOfStackReserve, data + 72, 8);
+    memcpy(&record->SizeOfStackCommit, data + 80, 8);
+    memcpy(&record->SizeOfHeapReserve, data + 88, 8);
+    memcpy(&record->SizeOfHeapCommit, data + 96, 8);
+    memcpy(&record->LoaderFlags, data + 104, 4);
+    memcpy(&record->NumberOfRvaAndSizes, data + 108, 4);
+    return true;
+}
+
+static void _decode_optional_header_pe32_plus(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u16(data + 0);
+    values[1] = _load_u8(data + 2);
+    values[2] = _load_u8(data + 3);
+    values[3] = _load_u32(data + 4);
+    values[4] = _load_u32(data + 8);
+    values[5] = _load_u32(data + 12);
+    values[6] = _load_u32(data + 16);
+    values[7] = _load_u32(data + 20);
+    values[8] = _load_u64(data + 24);
+    values[9] = _load_u32(data + 32);
+    values[10] = _load_u32(data + 36);
+    values[11] = _load_u16(data + 40);
+    values[12] = _load_u16(data + 42);
+    values[13] = _load_u16(data + 44);
+    values[14] = _load_u16(data + 46);
+    values[15] = _load_u16(data + 48);
+    values[16] = _load_u16(data + 50);
+    values[17] = _load_u32(data + 52);
+    values[18] = _load_u32(data + 56);
+    values[19] = _load_u32(data + 60);
+    values[20] = _load_u32(data + 64);
+    values[21] = _load_u16(data + 68);
+    values[22] = _load_u16(data + 70);
+    values[23] = _load_u64(data + 72);
+    values[24] = _load_u64(data + 80);
+    values[25] = _load_u64(data + 88);
+    values[26] = _load_u64(data + 96);
+    values[27] = _load_u32(data + 104);
+    values[28] = _load_u32(data + 108);
+}
+
+static const schema_field_layout_t _layout_optional_header_pe32_plus[] = {
+    { "Magic", 0, 2, NULL, NULL },
+    { "MajorLinkerVersion", 2, 1, NULL, NULL },
+    { "MinorLinkerVersion", 3, 1, NULL, NULL },
+    { "SizeOfCode", 4, 4, NULL, NULL },
+    { "SizeOfInitializedData", 8, 4, NULL, NULL },
+    { "SizeOfUninitializedData", 12, 4, NULL, NULL },
+    { "AddressOfEntryPoint", 16, 4, NULL, NULL },
+    { "BaseOfCode", 20, 4, NULL, NULL },
+    { "ImageBase", 24, 8, NULL, NULL },
+    { "SectionAlignment", 32, 4, NULL, NULL },
+    { "FileAlignment", 36, 4, NULL, NULL },
+    { "MajorOperatingSystemVersion", 40, 2, NULL, NULL },
+    { "MinorOperatingSystemVersion", 42, 2, NULL, NULL },
+    { "MajorImageVersion", 44, 2, NULL, NULL },
+    { "MinorImageVersion", 46, 2, NULL, NULL },
+    { "MajorSubsystemVersion", 48, 2, NULL, NULL },
+    { "MinorSubsystemVersion", 50, 2, NULL, NULL },
+    { "Win32VersionValue", 52, 4, NULL, NULL },
+    { "SizeOfImage", 56, 4, NULL, NULL },
+    { "SizeOfHeaders", 60, 4, NULL, NULL },
+    { "CheckSum", 64, 4, NULL, NULL },
+    { "Subsystem", 68, 2, NULL, NULL },
+    { "DllCharacteristics", 70, 2, NULL, NULL },
+    { "SizeOfStackReserve", 72, 8, NULL, NULL },
+    { "SizeOfStackCommit", 80, 8, NULL, NULL },
+    { "SizeOfHeapReserve", 88, 8, NULL, NULL },
+    { "SizeOfHeapCommit", 96, 8, NULL, NULL },
+    { "LoaderFlags", 104, 4, NULL, NULL },
+    { "NumberOfRvaAndSizes", 108, 4, NULL, NULL },
+};
+
+const char * schema_optional_header_pe32_plus_subsystem_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_SUBSYSTEM_UNKNOWN";
+        case 0x1: return "IMAGE_SUBSYSTEM_NATIVE";
+        case 0x2: return "IMAGE_SUBSYSTEM_WINDOWS_GUI";
+        case 0x3: return "IMAGE_SUBSYSTEM_WINDOWS_CUI";
+        case 0x7: return "IMAGE_SUBSYSTEM_POSIX_CUI";
+        case 0x9: return "IMAGE_SUBSYSTEM_WINDOWS_CE_GUI";
+        case 0xa: return "IMAGE_SUBSYSTEM_EFI_APPLICATION";
+        case 0xb: return "IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER";
+        case 0xc: return "IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER";
+        case 0xd: return "IMAGE_SUBSYSTEM_EFI_ROM";
+        case 0xe: return "IMAGE_SUBSYSTEM_XBOX";
+    }
+    return NULL;
+}
+
+const char * schema_optional_header_pe32_plus_dll_characteristics_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x40: return "IMAGE_DLL_CHARACTERISTICS_DYNAMIC_BASE";
+        case 0x80: return "IMAGE_DLL_CHARACTERISTICS_FORCE_INTEGRITY";
+        case 0x100: return "IMAGE_DLL_CHARACTERISTICS_NX_COMPAT";
+        case 0x200: return "IMAGE_DLLCHARACTERISTICS_NO_ISOLATION";
+        case 0x400: return "IMAGE_DLLCHARACTERISTICS_NO_SEH";
+        case 0x800: return "IMAGE_DLLCHARACTERISTICS_NO_BIND";
+        case 0x2000: return "IMAGE_DLLCHARACTERISTICS_WDM_DRIVER";
+        case 0x8000: return "IMAGE_DLLCHARACTERISTICS_TERMINAL_SERVER_AWARE";
+    }
+    return NULL;
+}
+
+bool schema_read_optional_header_data_directory(const pe_image_t *image, size_t offset, schema_optional_header_data_directory_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 8);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->Size, data + 4, 4);
+    return true;
+}
+
+static void _decode_optional_header_data_directory(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+}
+
+static const schema_field_layout_t _layout_optional_header_data_directory[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "Size", 4, 4, NULL, NULL },
+};
+
+bool schema_read_section_header(const pe_image_t *image, size_t offset, schema_section_header_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 40);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(record->Name, data + 0, 8);
+    memcpy(&record->VirtualSize, data + 8, 4);
+    memcpy(&record->VirtualAddress, data + 12, 4);
+    memcpy(&record->SizeOfRawData, data + 16, 4);
+    memcpy(&record->PointerToRawData, data + 20, 4);
+    memcpy(&record->PointerToRelocations, data + 24, 4);
+    memcpy(&record->PointerToLinenumbers, data + 28, 4);
+    memcpy(&record->NumberOfRelocations, data + 32, 2);
+    memcpy(&record->NumberOfLinenumbers, data + 34, 2);
+    memcpy(&record->Characteristics, data + 36, 4);
+    return true;
+}
+
+static void _decode_section_header(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u64(data + 0);
+    values[1] = _load_u32(data + 8);
+    values[2] = _load_u32(data + 12);
+    values[3] = _load_u32(data + 16);
+    values[4] = _load_u32(data + 20);
+    values[5] = _load_u32(data + 24);
+    values[6] = _load_u32(data + 28);
+    values[7] = _load_u16(data + 32);
+    values[8] = _load_u16(data + 34);
+    values[9] = _load_u32(data + 36);
+}
+
+static const schema_field_layout_t _layout_section_header[] = {
+    { "Name", 0, 8, NULL, NULL },
+    { "VirtualSize", 8, 4, NULL, NULL },
+    { "VirtualAddress", 12, 4, NULL, NULL },
+    { "SizeOfRawData", 16, 4, NULL, NULL },
+    { "PointerToRawData", 20, 4, NULL, NULL },
+    { "PointerToRelocations", 24, 4, NULL, NULL },
+    { "PointerToLinenumbers", 28, 4, NULL, NULL },
+    { "NumberOfRelocations", 32, 2, NULL, NULL },
+    { "NumberOfLinenumbers", 34, 2, NULL, NULL },
+    { "Characteristics", 36, 4, NULL, schema_section_header_characteristics_flags },
+};
+
+size_t schema_section_header_characteristics_flags(vis_value_t value, char *buffer, size_t size)
+{
+    size_t pos = 0;
+    for (vis_value_t bits = value; bits; bits &= bits - 1) {
+        switch (bits & (~bits + 1))
+        {
+            case 0x8: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_TYPE_NO_PAD "); break;
+            case 0x20: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_CNT_CODE "); break;
+            case 0x40: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_CNT_INITIALIZED_DATA "); break;
+            case 0x80: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_CNT_UNINITIALIZED_DATA "); break;
+            case 0x100: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_LNK_OTHER "); break;
+            case 0x200: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_LNK_INFO "); break;
+            case 0x800: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_LNK_REMOVE "); break;
+            case 0x1000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_LNK_COMDAT "); break;
+            case 0x8000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_GPREL "); break;
+            case 0x20000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_PURGEABLE IMAGE_SCN_MEM_16BIT "); break;
+            case 0x40000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_LOCKED "); break;
+            case 0x80000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_PRELOAD "); break;
+            case 0x100000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_1BYTES "); break;
+            case 0x200000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_2BYTES "); break;
+            case 0x400000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_8BYTES "); break;
+            case 0x800000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_128BYTES "); break;
+            case 0x1000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_LNK_NRELOC_OVFL "); break;
+            case 0x2000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_DISCARDABLE "); break;
+            case 0x4000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_NOT_CACHED "); break;
+            case 0x8000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_NOT_PAGED "); break;
+            case 0x10000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_SHARED "); break;
+            case 0x20000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_EXECUTE "); break;
+            case 0x40000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_READ "); break;
+            case 0x80000000: pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_MEM_WRITE "); break;
+        }
+    }
+    if (value & 0x300000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_4BYTES ");
+    }
+    if (value & 0x500000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_16BYTES ");
+    }
+    if (value & 0x600000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_32BYTES ");
+    }
+    if (value & 0x700000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_64BYTES ");
+    }
+    if (value & 0x900000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_256BYTES ");
+    }
+    if (value & 0xa00000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_512BYTES ");
+    }
+    if (value & 0xb00000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_1024BYTES ");
+    }
+    if (value & 0xc00000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_2048BYTES ");
+    }
+    if (value & 0xd00000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_4096BYTES ");
+    }
+    if (value & 0xe00000) {
+        pos = vis_append_str(buffer, size, pos, "IMAGE_SCN_ALIGN_8192BYTES ");
+    }
+    if (pos == 0 && size > 0) {
+        buffer[0] = '\0';
+    }
+    return pos;
+}
+
+bool schema_read_coff_relocation_amd64(const pe_image_t *image, size_t offset, schema_coff_relocation_amd64_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_amd64(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_amd64[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_amd64_type_name, NULL },
+};
+
+const char * schema_coff_relocation_amd64_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_AMD64_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_AMD64_ADDR64";
+        case 0x2: return "IMAGE_REL_AMD64_ADDR32";
+        case 0x3: return "IMAGE_REL_AMD64_ADDR32NB";
+        case 0x4: return "IMAGE_REL_AMD64_REL32";
+        case 0x5: return "IMAGE_REL_AMD64_REL32_1";
+        case 0x6: return "IMAGE_REL_AMD64_REL32_2";
+        case 0x7: return "IMAGE_REL_AMD64_REL32_3";
+        case 0x8: return "IMAGE_REL_AMD64_REL32_4";
+        case 0x9: return "IMAGE_REL_AMD64_REL32_5";
+        case 0xa: return "IMAGE_REL_AMD64_SECTION";
+        case 0xb: return "IMAGE_REL_AMD64_SECREL";
+        case 0xc: return "IMAGE_REL_AMD64_SECREL7";
+        case 0xd: return "IMAGE_REL_AMD64_TOKEN";
+        case 0xe: return "IMAGE_REL_AMD64_SREL32";
+        case 0xf: return "IMAGE_REL_AMD64_PAIR";
+        case 0x10: return "IMAGE_REL_AMD64_SSPAN32";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_arm(const pe_image_t *image, size_t offset, schema_coff_relocation_arm_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_arm(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_arm[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_arm_type_name, NULL },
+};
+
+const char * schema_coff_relocation_arm_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_ARM_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_ARM_ADDR32";
+        case 0x2: return "IMAGE_REL_ARM_ADDR32NB";
+        case 0x3: return "IMAGE_REL_ARM_BRANCH24";
+        case 0x4: return "IMAGE_REL_ARM_BRANCH11";
+        case 0x5: return "IMAGE_REL_ARM_TOKEN";
+        case 0x8: return "IMAGE_REL_ARM_BLX24";
+        case 0x9: return "IMAGE_REL_ARM_BLX11";
+        case 0xe: return "IMAGE_REL_ARM_SECTION";
+        case 0xf: return "IMAGE_REL_ARM_SECREL";
+        case 0x10: return "IMAGE_REL_ARM_MOV32A";
+        case 0x11: return "IMAGE_REL_ARM_MOV32T";
+        case 0x12: return "IMAGE_REL_ARM_BRANCH20T";
+        case 0x14: return "IMAGE_REL_ARM_BRANCH24T";
+        case 0x15: return "IMAGE_REL_ARM_BLX23T";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_arm64(const pe_image_t *image, size_t offset, schema_coff_relocation_arm64_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_arm64(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_arm64[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_arm64_type_name, NULL },
+};
+
+const char * schema_coff_relocation_arm64_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_ARM64_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_ARM64_ADDR32";
+        case 0x2: return "IMAGE_REL_ARM64_ADDR32NB";
+        case 0x3: return "IMAGE_REL_ARM64_BRANCH26";
+        case 0x4: return "IMAGE_REL_ARM64_PAGEBASE_REL21";
+        case 0x5: return "IMAGE_REL_ARM64_REL21";
+        case 0x6: return "IMAGE_REL_ARM64_PAGEOFFSET_12A";
+        case 0x7: return "IMAGE_REL_ARM64_PAGEOFFSET_12L";
+        case 0x8: return "IMAGE_REL_ARM64_SECREL";
+        case 0x9: return "IMAGE_REL_ARM64_SECREL_LOW12A";
+        case 0xa: return "IMAGE_REL_ARM64_SECREL_HIGH12A";
+        case 0xb: return "IMAGE_REL_ARM64_SECREL_LOW12L";
+        case 0xc: return "IMAGE_REL_ARM64_TOKEN";
+        case 0xd: return "IMAGE_REL_ARM64_SECTION";
+        case 0xe: return "IMAGE_REL_ARM64_ADDR64";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_sh3(const pe_image_t *image, size_t offset, schema_coff_relocation_sh3_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_sh3(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_sh3[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_sh3_type_name, NULL },
+};
+
+const char * schema_coff_relocation_sh3_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_SH3_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_SH3_DIRECT16";
+        case 0x2: return "IMAGE_REL_SH3_DIRECT32";
+        case 0x3: return "IMAGE_REL_SH3_DIRECT8";
+        case 0x4: return "IMAGE_REL_SH3_DIRECT8_WORD";
+        case 0x5: return "IMAGE_REL_SH3_DIRECT8_LONG";
+        case 0x6: return "IMAGE_REL_SH3_DIRECT4";
+        case 0x7: return "IMAGE_REL_SH3_DIRECT4_WORD";
+        case 0x8: return "IMAGE_REL_SH3_DIRECT4_LONG";
+        case 0x9: return "IMAGE_REL_SH3_PCREL8_WORD";
+        case 0xa: return "IMAGE_REL_SH3_PCREL8_LONG";
+        case 0xb: return "IMAGE_REL_SH3_PCREL12_WORD";
+        case 0xc: return "IMAGE_REL_SH3_STARTOF_SECTION";
+        case 0xd: return "IMAGE_REL_SH3_SIZEOF_SECTION";
+        case 0xe: return "IMAGE_REL_SH3_SECTION";
+        case 0xf: return "IMAGE_REL_SH3_SECREL";
+        case 0x10: return "IMAGE_REL_SH3_DIRECT32_NB";
+        case 0x11: return "IMAGE_REL_SH3_GPREL4_LONG";
+        case 0x12: return "IMAGE_REL_SH3_TOKEN";
+        case 0x13: return "IMAGE_REL_SHM_PCRELPT";
+        case 0x14: return "IMAGE_REL_SHM_REFLO";
+        case 0x15: return "IMAGE_REL_SHM_REFHALF";
+        case 0x16: return "IMAGE_REL_SHM_RELLO";
+        case 0x17: return "IMAGE_REL_SHM_RELHALF";
+        case 0x18: return "IMAGE_REL_SHM_PAIR";
+        case 0x8000: return "IMAGE_REL_SHM_NOMODE";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_ppc(const pe_image_t *image, size_t offset, schema_coff_relocation_ppc_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_ppc(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_ppc[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_ppc_type_name, NULL },
+};
+
+const char * schema_coff_relocation_ppc_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_PPC_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_PPC_ADDR64";
+        case 0x2: return "IMAGE_REL_PPC_ADDR32";
+        case 0x3: return "IMAGE_REL_PPC_ADDR24";
+        case 0x4: return "IMAGE_REL_PPC_ADDR16";
+        case 0x5: return "IMAGE_REL_PPC_ADDR14";
+        case 0x6: return "IMAGE_REL_PPC_REL24";
+        case 0x7: return "IMAGE_REL_PPC_REL14";
+        case 0xa: return "IMAGE_REL_PPC_ADDR32NB";
+        case 0xb: return "IMAGE_REL_PPC_SECREL";
+        case 0xc: return "IMAGE_REL_PPC_SECTION";
+        case 0xf: return "IMAGE_REL_PPC_SECREL16";
+        case 0x10: return "IMAGE_REL_PPC_REFHI";
+        case 0x11: return "IMAGE_REL_PPC_REFLO";
+        case 0x12: return "IMAGE_REL_PPC_PAIR";
+        case 0x13: return "IMAGE_REL_PPC_SECRELLO";
+        case 0x15: return "IMAGE_REL_PPC_GPREL";
+        case 0x16: return "IMAGE_REL_PPC_TOKEN";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_i386(const pe_image_t *image, size_t offset, schema_coff_relocation_i386_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_i386(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_i386[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_i386_type_name, NULL },
+};
+
+const char * schema_coff_relocation_i386_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_I386_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_I386_DIR16";
+        case 0x2: return "IMAGE_REL_I386_REL16";
+        case 0x6: return "IMAGE_REL_I386_DIR32";
+        case 0x7: return "IMAGE_REL_I386_DIR32NB";
+        case 0x9: return "IMAGE_REL_I386_SEG12";
+        case 0xa: return "IMAGE_REL_I386_SECTION";
+        case 0xb: return "IMAGE_REL_I386_SECREL";
+        case 0xc: return "IMAGE_REL_I386_TOKEN";
+        case 0xd: return "IMAGE_REL_I386_SECREL7";
+        case 0x14: return "IMAGE_REL_I386_REL32";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_ia64(const pe_image_t *image, size_t offset, schema_coff_relocation_ia64_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_ia64(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_ia64[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_ia64_type_name, NULL },
+};
+
+const char * schema_coff_relocation_ia64_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_IA64_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_IA64_IMM14";
+        case 0x2: return "IMAGE_REL_IA64_IMM22";
+        case 0x3: return "IMAGE_REL_IA64_IMM64";
+        case 0x4: return "IMAGE_REL_IA64_DIR32";
+        case 0x5: return "IMAGE_REL_IA64_DIR64";
+        case 0x6: return "IMAGE_REL_IA64_PCREL21B";
+        case 0x7: return "IMAGE_REL_IA64_PCREL21M";
+        case 0x8: return "IMAGE_REL_IA64_PCREL21F";
+        case 0x9: return "IMAGE_REL_IA64_GPREL22";
+        case 0xa: return "IMAGE_REL_IA64_LTOFF22";
+        case 0xb: return "IMAGE_REL_IA64_SECTION";
+        case 0xc: return "IMAGE_REL_IA64_SECREL22";
+        case 0xd: return "IMAGE_REL_IA64_SECREL64I";
+        case 0xe: return "IMAGE_REL_IA64_SECREL32";
+        case 0x10: return "IMAGE_REL_IA64_DIR32NB";
+        case 0x11: return "IMAGE_REL_IA64_SREL14";
+        case 0x12: return "IMAGE_REL_IA64_SREL22";
+        case 0x13: return "IMAGE_REL_IA64_SREL32";
+        case 0x14: return "IMAGE_REL_IA64_UREL32";
+        case 0x15: return "IMAGE_REL_IA64_PCREL60X";
+        case 0x16: return "IMAGE_REL_IA64_PCREL60B";
+        case 0x17: return "IMAGE_REL_IA64_PCREL60F";
+        case 0x18: return "IMAGE_REL_IA64_PCREL60I";
+        case 0x19: return "IMAGE_REL_IA64_PCREL60M";
+        case 0x1a: return "IMAGE_REL_IA64_IMMGPREL64";
+        case 0x1b: return "IMAGE_REL_IA64_TOKEN";
+        case 0x1c: return "IMAGE_REL_IA64_GPREL32";
+        case 0x1f: return "IMAGE_REL_IA64_ADDEND";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_mips(const pe_image_t *image, size_t offset, schema_coff_relocation_mips_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_mips(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_mips[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_mips_type_name, NULL },
+};
+
+const char * schema_coff_relocation_mips_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_MIPS_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_MIPS_REFHALF";
+        case 0x2: return "IMAGE_REL_MIPS_REFWORD";
+        case 0x3: return "IMAGE_REL_MIPS_JMPADDR";
+        case 0x4: return "IMAGE_REL_MIPS_REFHI";
+        case 0x5: return "IMAGE_REL_MIPS_REFLO";
+        case 0x6: return "IMAGE_REL_MIPS_GPREL";
+        case 0x7: return "IMAGE_REL_MIPS_LITERAL";
+        case 0xa: return "IMAGE_REL_MIPS_SECTION";
+        case 0xb: return "IMAGE_REL_MIPS_SECREL";
+        case 0xc: return "IMAGE_REL_MIPS_SECRELLO";
+        case 0xd: return "IMAGE_REL_MIPS_SECRELHI";
+        case 0x10: return "IMAGE_REL_MIPS_JMPADDR16";
+        case 0x22: return "IMAGE_REL_MIPS_REFWORDNB";
+        case 0x25: return "IMAGE_REL_MIPS_PAIR";
+    }
+    return NULL;
+}
+
+bool schema_read_coff_relocation_m32r(const pe_image_t *image, size_t offset, schema_coff_relocation_m32r_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 10);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->VirtualAddress, data + 0, 4);
+    memcpy(&record->SymbolTableIndex, data + 4, 4);
+    memcpy(&record->Type, data + 8, 2);
+    return true;
+}
+
+static void _decode_coff_relocation_m32r(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+}
+
+static const schema_field_layout_t _layout_coff_relocation_m32r[] = {
+    { "VirtualAddress", 0, 4, NULL, NULL },
+    { "SymbolTableIndex", 4, 4, NULL, NULL },
+    { "Type", 8, 2, schema_coff_relocation_m32r_type_name, NULL },
+};
+
+const char * schema_coff_relocation_m32r_type_name(vis_value_t value)
+{
+    switch (value)
+    {
+        case 0x0: return "IMAGE_REL_M32R_ABSOLUTE";
+        case 0x1: return "IMAGE_REL_M32R_ADDR32";
+        case 0x2: return "IMAGE_REL_M32R_ADDR32NB";
+        case 0x3: return "IMAGE_REL_M32R_ADDR24";
+        case 0x4: return "IMAGE_REL_M32R_GPREL16";
+        case 0x5: return "IMAGE_REL_M32R_PCREL24";
+        case 0x6: return "IMAGE_REL_M32R_PCREL16";
+        case 0x7: return "IMAGE_REL_M32R_PCREL8";
+        case 0x8: return "IMAGE_REL_M32R_REFHALF";
+        case 0x9: return "IMAGE_REL_M32R_REFHI";
+        case 0xa: return "IMAGE_REL_M32R_REFLO";
+        case 0xb: return "IMAGE_REL_M32R_PAIR";
+        case 0xc: return "IMAGE_REL_M32R_SECTION";
+        case 0xd: return "IMAGE_REL_M32R_SECREL";
+        case 0xe: return "IMAGE_REL_M32R_TOKEN";
+    }
+    return NULL;
+}
+
+bool schema_read_tls_directory_pe32(const pe_image_t *image, size_t offset, schema_tls_directory_pe32_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 24);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->RawDataStartVA, data + 0, 4);
+    memcpy(&record->RawDataEndVA, data + 4, 4);
+    memcpy(&record->AddressOfIndex, data + 8, 4);
+    memcpy(&record->AddressOfCallbacks, data + 12, 4);
+    memcpy(&record->SizeOfZeroFill, data + 16, 4);
+    memcpy(&record->Characteristics, data + 20, 4);
+    return true;
+}
+
+static void _decode_tls_directory_pe32(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u32(data + 8);
+    values[3] = _load_u32(data + 12);
+    values[4] = _load_u32(data + 16);
+    values[5] = _load_u32(data + 20);
+}
+
+static const schema_field_layout_t _layout_tls_directory_pe32[] = {
+    { "RawDataStartVA", 0, 4, NULL, NULL },
+    { "RawDataEndVA", 4, 4, NULL, NULL },
+    { "AddressOfIndex", 8, 4, NULL, NULL },
+    { "AddressOfCallbacks", 12, 4, NULL, NULL },
+    { "SizeOfZeroFill", 16, 4, NULL, NULL },
+    { "Characteristics", 20, 4, NULL, NULL },
+};
+
+bool schema_read_tls_directory_pe32_plus(const pe_image_t *image, size_t offset, schema_tls_directory_pe32_plus_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 40);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->RawDataStartVA, data + 0, 8);
+    memcpy(&record->RawDataEndVA, data + 8, 8);
+    memcpy(&record->AddressOfIndex, data + 16, 8);
+    memcpy(&record->AddressOfCallbacks, data + 24, 8);
+    memcpy(&record->SizeOfZeroFill, data + 32, 4);
+    memcpy(&record->Characteristics, data + 36, 4);
+    return true;
+}
+
+static void _decode_tls_directory_pe32_plus(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u64(data + 0);
+    values[1] = _load_u64(data + 8);
+    values[2] = _load_u64(data + 16);
+    values[3] = _load_u64(data + 24);
+    values[4] = _load_u32(data + 32);
+    values[5] = _load_u32(data + 36);
+}
+
+static const schema_field_layout_t _layout_tls_directory_pe32_plus[] = {
+    { "RawDataStartVA", 0, 8, NULL, NULL },
+    { "RawDataEndVA", 8, 8, NULL, NULL },
+    { "AddressOfIndex", 16, 8, NULL, NULL },
+    { "AddressOfCallbacks", 24, 8, NULL, NULL },
+    { "SizeOfZeroFill", 32, 4, NULL, NULL },
+    { "Characteristics", 36, 4, NULL, NULL },
+};
+
+bool schema_read_load_config_directory_pe32(const pe_image_t *image, size_t offset, schema_load_config_directory_pe32_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 172);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->Size, data + 0, 4);
+    memcpy(&record->TimeDateStamp, data + 4, 4);
+    memcpy(&record->MajorVersion, data + 8, 2);
+    memcpy(&record->MinorVersion, data + 10, 2);
+    memcpy(&record->GlobalFlagsClear, data + 12, 4);
+    memcpy(&record->GlobalFlagsSet, data + 16, 4);
+    memcpy(&record->CriticalSectionDefaultTimeout, data + 20, 4);
+    memcpy(&record->DeCommitFreeBlockThreshold, data + 24, 4);
+    memcpy(&record->DeCommitTotalFreeThreshold, data + 28, 4);
+    memcpy(&record->LockPrefixTable, data + 32, 4);
+    memcpy(&record->MaximumAllocationSize, data + 36, 4);
+    memcpy(&record->VirtualMemoryThreshold, data + 40, 4);
+    memcpy(&record->ProcessHeapFlags, data + 44, 4);
+    memcpy(&record->ProcessAffinityMask, data + 48, 4);
+    memcpy(&record->CSDVersion, data + 52, 2);
+    memcpy(&record->DependentLoadFlags, data + 54, 2);
+    memcpy(&record->EditList, data + 56, 4);
+    memcpy(&record->SecurityCookie, data + 60, 4);
+    memcpy(&record->SEHandlerTable, data + 64, 4);
+    memcpy(&record->SEHandlerCount, data + 68, 4);
+    memcpy(&record->GuardCFCheckFunctionPointer, data + 72, 4);
+    memcpy(&record->GuardCFDispatchFunctionPointer, data + 76, 4);
+    memcpy(&record->GuardCFFunctionTable, data + 80, 4);
+    memcpy(&record->GuardCFFunctionCount, data + 84, 4);
+    memcpy(&record->GuardFlags, data + 88, 4);
+    memcpy(&record->CodeIntegrityFlags, data + 92, 2);
+    memcpy(&record->CodeIntegrityCatalog, data + 94, 2);
+    memcpy(&record->CodeIntegrityCatalogOffset, data + 96, 4);
+    memcpy(&record->CodeIntegrityReserved, data + 100, 4);
+    memcpy(&record->GuardAddressTakenIatEntryTable, data + 104, 4);
+    memcpy(&record->GuardAddressTakenIatEntryCount, data + 108, 4);
+    memcpy(&record->GuardLongJumpTargetTable, data + 112, 4);
+    memcpy(&record->GuardLongJumpTargetCount, data + 116, 4);
+    memcpy(&record->DynamicValueRelocTable, data + 120, 4);
+    memcpy(&record->CHPEMetadataPointer, data + 124, 4);
+    memcpy(&record->GuardRFFailureRoutine, data + 128, 4);
+    memcpy(&record->GuardRFFailureRoutineFunctionPointer, data + 132, 4);
+    memcpy(&record->DynamicValueRelocTableOffset, data + 136, 4);
+    memcpy(&record->DynamicValueRelocTableSection, data + 140, 2);
+    memcpy(&record->Reserved2, data + 142, 2);
+    memcpy(&record->GuardRFVerifyStackPointerFunctionPointer, data + 144, 4);
+    memcpy(&record->HotPatchTableOffset, data + 148, 4);
+    memcpy(&record->Reserved3, data + 152, 4);
+    memcpy(&record->EnclaveConfigurationPointer, data + 156, 4);
+    memcpy(&record->VolatileMetadataPointer, data + 160, 4);
+    memcpy(&record->GuardEHContinuationTable, data + 164, 4);
+    memcpy(&record->GuardEHContinuationCount, data + 168, 4);
+    return true;
+}
+
+static void _decode_load_config_directory_pe32(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+    values[3] = _load_u16(data + 10);
+    values[4] = _load_u32(data + 12);
+    values[5] = _load_u32(data + 16);
+    values[6] = _load_u32(data + 20);
+    values[7] = _load_u32(data + 24);
+    values[8] = _load_u32(data + 28);
+    values[9] = _load_u32(data + 32);
+    values[10] = _load_u32(data + 36);
+    values[11] = _load_u32(data + 40);
+    values[12] = _load_u32(data + 44);
+    values[13] = _load_u32(data + 48);
+    values[14] = _load_u16(data + 52);
+    values[15] = _load_u16(data + 54);
+    values[16] = _load_u32(data + 56);
+    values[17] = _load_u32(data + 60);
+    values[18] = _load_u32(data + 64);
+    values[19] = _load_u32(data + 68);
+    values[20] = _load_u32(data + 72);
+    values[21] = _load_u32(data + 76);
+    values[22] = _load_u32(data + 80);
+    values[23] = _load_u32(data + 84);
+    values[24] = _load_u32(data + 88);
+    values[25] = _load_u16(data + 92);
+    values[26] = _load_u16(data + 94);
+    values[27] = _load_u32(data + 96);
+    values[28] = _load_u32(data + 100);
+    values[29] = _load_u32(data + 104);
+    values[30] = _load_u32(data + 108);
+    values[31] = _load_u32(data + 112);
+    values[32] = _load_u32(data + 116);
+    values[33] = _load_u32(data + 120);
+    values[34] = _load_u32(data + 124);
+    values[35] = _load_u32(data + 128);
+    values[36] = _load_u32(data + 132);
+    values[37] = _load_u32(data + 136);
+    values[38] = _load_u16(data + 140);
+    values[39] = _load_u16(data + 142);
+    values[40] = _load_u32(data + 144);
+    values[41] = _load_u32(data + 148);
+    values[42] = _load_u32(data + 152);
+    values[43] = _load_u32(data + 156);
+    values[44] = _load_u32(data + 160);
+    values[45] = _load_u32(data + 164);
+    values[46] = _load_u32(data + 168);
+}
+
+static const schema_field_layout_t _layout_load_config_directory_pe32[] = {
+    { "Size", 0, 4, NULL, NULL },
+    { "TimeDateStamp", 4, 4, NULL, NULL },
+    { "MajorVersion", 8, 2, NULL, NULL },
+    { "MinorVersion", 10, 2, NULL, NULL },
+    { "GlobalFlagsClear", 12, 4, NULL, NULL },
+    { "GlobalFlagsSet", 16, 4, NULL, NULL },
+    { "CriticalSectionDefaultTimeout", 20, 4, NULL, NULL },
+    { "DeCommitFreeBlockThreshold", 24, 4, NULL, NULL },
+    { "DeCommitTotalFreeThreshold", 28, 4, NULL, NULL },
+    { "LockPrefixTable", 32, 4, NULL, NULL },
+    { "MaximumAllocationSize", 36, 4, NULL, NULL },
+    { "VirtualMemoryThreshold", 40, 4, NULL, NULL },
+    { "ProcessHeapFlags", 44, 4, NULL, NULL },
+    { "ProcessAffinityMask", 48, 4, NULL, NULL },
+    { "CSDVersion", 52, 2, NULL, NULL },
+    { "DependentLoadFlags", 54, 2, NULL, NULL },
+    { "EditList", 56, 4, NULL, NULL },
+    { "SecurityCookie", 60, 4, NULL, NULL },
+    { "SEHandlerTable", 64, 4, NULL, NULL },
+    { "SEHandlerCount", 68, 4, NULL, NULL },
+    { "GuardCFCheckFunctionPointer", 72, 4, NULL, NULL },
+    { "GuardCFDispatchFunctionPointer", 76, 4, NULL, NULL },
+    { "GuardCFFunctionTable", 80, 4, NULL, NULL },
+    { "GuardCFFunctionCount", 84, 4, NULL, NULL },
+    { "GuardFlags", 88, 4, NULL, schema_load_config_directory_pe32_guard_flags_flags },
+    { "CodeIntegrityFlags", 92, 2, NULL, NULL },
+    { "CodeIntegrityCatalog", 94, 2, NULL, NULL },
+    { "CodeIntegrityCatalogOffset", 96, 4, NULL, NULL },
+    { "CodeIntegrityReserved", 100, 4, NULL, NULL },
+    { "GuardAddressTakenIatEntryTable", 104, 4, NULL, NULL },
+    { "GuardAddressTakenIatEntryCount", 108, 4, NULL, NULL },
+    { "GuardLongJumpTargetTable", 112, 4, NULL, NULL },
+    { "GuardLongJumpTargetCount", 116, 4, NULL, NULL },
+    { "DynamicValueRelocTable", 120, 4, NULL, NULL },
+    { "CHPEMetadataPointer", 124, 4, NULL, NULL },
+    { "GuardRFFailureRoutine", 128, 4, NULL, NULL },
+    { "GuardRFFailureRoutineFunctionPointer", 132, 4, NULL, NULL },
+    { "DynamicValueRelocTableOffset", 136, 4, NULL, NULL },
+    { "DynamicValueRelocTableSection", 140, 2, NULL, NULL },
+    { "Reserved2", 142, 2, NULL, NULL },
+    { "GuardRFVerifyStackPointerFunctionPointer", 144, 4, NULL, NULL },
+    { "HotPatchTableOffset", 148, 4, NULL, NULL },
+    { "Reserved3", 152, 4, NULL, NULL },
+    { "EnclaveConfigurationPointer", 156, 4, NULL, NULL },
+    { "VolatileMetadataPointer", 160, 4, NULL, NULL },
+    { "GuardEHContinuationTable", 164, 4, NULL, NULL },
+    { "GuardEHContinuationCount", 168, 4, NULL, NULL },
+};
+
+size_t schema_load_config_directory_pe32_guard_flags_flags(vis_value_t value, char *buffer, size_t size)
+{
+    size_t pos = 0;
+    for (vis_value_t bits = value; bits; bits &= bits - 1) {
+        switch (bits & (~bits + 1))
+        {
+            case 0x100: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_INSTRUMENTED "); break;
+            case 0x200: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CFW_INSTRUMENTED "); break;
+            case 0x400: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_FUNCTION_TABLE_PRESENT "); break;
+            case 0x800: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_SECURITY_COOKIE_UNUSED "); break;
+            case 0x1000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_PROTECT_DELAYLOAD_IAT "); break;
+            case 0x2000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_DELAYLOAD_IAT_IN_ITS_OWN_SECTION "); break;
+            case 0x4000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_EXPORT_SUPPRESSION_INFO_PRESENT "); break;
+            case 0x8000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_ENABLE_EXPORT_SUPPRESSION "); break;
+            case 0x10000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_LONGJUMP_TABLE_PRESENT "); break;
+            case 0x20000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RF_INSTRUMENTED "); break;
+            case 0x40000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RF_ENABLE "); break;
+            case 0x80000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RF_STRICT "); break;
+            case 0x100000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RETPOLINE_PRESENT "); break;
+            case 0x400000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_EH_CONTINUATION_TABLE_PRESENT "); break;
+        }
+    }
+    if (pos == 0 && size > 0) {
+        buffer[0] = '\0';
+    }
+    return pos;
+}
+
+bool schema_read_load_config_directory_pe32_plus(const pe_image_t *image, size_t offset, schema_load_config_directory_pe32_plus_t *record)
+{
+    const uint8_t *data = image_ptr(image, offset, 280);
+    if (!data) {
+        set_error("Read past the end of image");
+        return false;
+    }
+    memcpy(&record->Size, data + 0, 4);
+    memcpy(&record->TimeDateStamp, data + 4, 4);
+    memcpy(&record->MajorVersion, data + 8, 2);
+    memcpy(&record->MinorVersion, data + 10, 2);
+    memcpy(&record->GlobalFlagsClear, data + 12, 4);
+    memcpy(&record->GlobalFlagsSet, data + 16, 4);
+    memcpy(&record->CriticalSectionDefaultTimeout, data + 20, 4);
+    memcpy(&record->DeCommitFreeBlockThreshold, data + 24, 8);
+    memcpy(&record->DeCommitTotalFreeThreshold, data + 32, 8);
+    memcpy(&record->LockPrefixTable, data + 40, 8);
+    memcpy(&record->MaximumAllocationSize, data + 48, 8);
+    memcpy(&record->VirtualMemoryThreshold, data + 56, 8);
+    memcpy(&record->ProcessAffinityMask, data + 64, 8);
+    memcpy(&record->ProcessHeapFlags, data + 72, 4);
+    memcpy(&record->CSDVersion, data + 76, 2);
+    memcpy(&record->DependentLoadFlags, data + 78, 2);
+    memcpy(&record->EditList, data + 80, 8);
+    memcpy(&record->SecurityCookie, data + 88, 8);
+    memcpy(&record->SEHandlerTable, data + 96, 8);
+    memcpy(&record->SEHandlerCount, data + 104, 8);
+    memcpy(&record->GuardCFCheckFunctionPointer, data + 112, 8);
+    memcpy(&record->GuardCFDispatchFunctionPointer, data + 120, 8);
+    memcpy(&record->GuardCFFunctionTable, data + 128, 8);
+    memcpy(&record->GuardCFFunctionCount, data + 136, 8);
+    memcpy(&record->GuardFlags, data + 144, 4);
+    memcpy(&record->CodeIntegrityFlags, data + 148, 2);
+    memcpy(&record->CodeIntegrityCatalog, data + 150, 2);
+    memcpy(&record->CodeIntegrityCatalogOffset, data + 152, 4);
+    memcpy(&record->CodeIntegrityReserved, data + 156, 4);
+    memcpy(&record->GuardAddressTakenIatEntryTable, data + 160, 8);
+    memcpy(&record->GuardAddressTakenIatEntryCount, data + 168, 8);
+    memcpy(&record->GuardLongJumpTargetTable, data + 176, 8);
+    memcpy(&record->GuardLongJumpTargetCount, data + 184, 8);
+    memcpy(&record->DynamicValueRelocTable, data + 192, 8);
+    memcpy(&record->CHPEMetadataPointer, data + 200, 8);
+    memcpy(&record->GuardRFFailureRoutine, data + 208, 8);
+    memcpy(&record->GuardRFFailureRoutineFunctionPointer, data + 216, 8);
+    memcpy(&record->DynamicValueRelocTableOffset, data + 224, 4);
+    memcpy(&record->DynamicValueRelocTableSection, data + 228, 2);
+    memcpy(&record->Reserved2, data + 230, 2);
+    memcpy(&record->GuardRFVerifyStackPointerFunctionPointer, data + 232, 8);
+    memcpy(&record->HotPatchTableOffset, data + 240, 4);
+    memcpy(&record->Reserved3, data + 244, 4);
+    memcpy(&record->EnclaveConfigurationPointer, data + 248, 8);
+    memcpy(&record->VolatileMetadataPointer, data + 256, 8);
+    memcpy(&record->GuardEHContinuationTable, data + 264, 8);
+    memcpy(&record->GuardEHContinuationCount, data + 272, 8);
+    return true;
+}
+
+static void _decode_load_config_directory_pe32_plus(const uint8_t *data, vis_value_t *values)
+{
+    values[0] = _load_u32(data + 0);
+    values[1] = _load_u32(data + 4);
+    values[2] = _load_u16(data + 8);
+    values[3] = _load_u16(data + 10);
+    values[4] = _load_u32(data + 12);
+    values[5] = _load_u32(data + 16);
+    values[6] = _load_u32(data + 20);
+    values[7] = _load_u64(data + 24);
+    values[8] = _load_u64(data + 32);
+    values[9] = _load_u64(data + 40);
+    values[10] = _load_u64(data + 48);
+    values[11] = _load_u64(data + 56);
+    values[12] = _load_u64(data + 64);
+    values[13] = _load_u32(data + 72);
+    values[14] = _load_u16(data + 76);
+    values[15] = _load_u16(data + 78);
+    values[16] = _load_u64(data + 80);
+    values[17] = _load_u64(data + 88);
+    values[18] = _load_u64(data + 96);
+    values[19] = _load_u64(data + 104);
+    values[20] = _load_u64(data + 112);
+    values[21] = _load_u64(data + 120);
+    values[22] = _load_u64(data + 128);
+    values[23] = _load_u64(data + 136);
+    values[24] = _load_u32(data + 144);
+    values[25] = _load_u16(data + 148);
+    values[26] = _load_u16(data + 150);
+    values[27] = _load_u32(data + 152);
+    values[28] = _load_u32(data + 156);
+    values[29] = _load_u64(data + 160);
+    values[30] = _load_u64(data + 168);
+    values[31] = _load_u64(data + 176);
+    values[32] = _load_u64(data + 184);
+    values[33] = _load_u64(data + 192);
+    values[34] = _load_u64(data + 200);
+    values[35] = _load_u64(data + 208);
+    values[36] = _load_u64(data + 216);
+    values[37] = _load_u32(data + 224);
+    values[38] = _load_u16(data + 228);
+    values[39] = _load_u16(data + 230);
+    values[40] = _load_u64(data + 232);
+    values[41] = _load_u32(data + 240);
+    values[42] = _load_u32(data + 244);
+    values[43] = _load_u64(data + 248);
+    values[44] = _load_u64(data + 256);
+    values[45] = _load_u64(data + 264);
+    values[46] = _load_u64(data + 272);
+}
+
+static const schema_field_layout_t _layout_load_config_directory_pe32_plus[] = {
+    { "Size", 0, 4, NULL, NULL },
+    { "TimeDateStamp", 4, 4, NULL, NULL },
+    { "MajorVersion", 8, 2, NULL, NULL },
+    { "MinorVersion", 10, 2, NULL, NULL },
+    { "GlobalFlagsClear", 12, 4, NULL, NULL },
+    { "GlobalFlagsSet", 16, 4, NULL, NULL },
+    { "CriticalSectionDefaultTimeout", 20, 4, NULL, NULL },
+    { "DeCommitFreeBlockThreshold", 24, 8, NULL, NULL },
+    { "DeCommitTotalFreeThreshold", 32, 8, NULL, NULL },
+    { "LockPrefixTable", 40, 8, NULL, NULL },
+    { "MaximumAllocationSize", 48, 8, NULL, NULL },
+    { "VirtualMemoryThreshold", 56, 8, NULL, NULL },
+    { "ProcessAffinityMask", 64, 8, NULL, NULL },
+    { "ProcessHeapFlags", 72, 4, NULL, NULL },
+    { "CSDVersion", 76, 2, NULL, NULL },
+    { "DependentLoadFlags", 78, 2, NULL, NULL },
+    { "EditList", 80, 8, NULL, NULL },
+    { "SecurityCookie", 88, 8, NULL, NULL },
+    { "SEHandlerTable", 96, 8, NULL, NULL },
+    { "SEHandlerCount", 104, 8, NULL, NULL },
+    { "GuardCFCheckFunctionPointer", 112, 8, NULL, NULL },
+    { "GuardCFDispatchFunctionPointer", 120, 8, NULL, NULL },
+    { "GuardCFFunctionTable", 128, 8, NULL, NULL },
+    { "GuardCFFunctionCount", 136, 8, NULL, NULL },
+    { "GuardFlags", 144, 4, NULL, schema_load_config_directory_pe32_plus_guard_flags_flags },
+    { "CodeIntegrityFlags", 148, 2, NULL, NULL },
+    { "CodeIntegrityCatalog", 150, 2, NULL, NULL },
+    { "CodeIntegrityCatalogOffset", 152, 4, NULL, NULL },
+    { "CodeIntegrityReserved", 156, 4, NULL, NULL },
+    { "GuardAddressTakenIatEntryTable", 160, 8, NULL, NULL },
+    { "GuardAddressTakenIatEntryCount", 168, 8, NULL, NULL },
+    { "GuardLongJumpTargetTable", 176, 8, NULL, NULL },
+    { "GuardLongJumpTargetCount", 184, 8, NULL, NULL },
+    { "DynamicValueRelocTable", 192, 8, NULL, NULL },
+    { "CHPEMetadataPointer", 200, 8, NULL, NULL },
+    { "GuardRFFailureRoutine", 208, 8, NULL, NULL },
+    { "GuardRFFailureRoutineFunctionPointer", 216, 8, NULL, NULL },
+    { "DynamicValueRelocTableOffset", 224, 4, NULL, NULL },
+    { "DynamicValueRelocTableSection", 228, 2, NULL, NULL },
+    { "Reserved2", 230, 2, NULL, NULL },
+    { "GuardRFVerifyStackPointerFunctionPointer", 232, 8, NULL, NULL },
+    { "HotPatchTableOffset", 240, 4, NULL, NULL },
+    { "Reserved3", 244, 4, NULL, NULL },
+    { "EnclaveConfigurationPointer", 248, 8, NULL, NULL },
+    { "VolatileMetadataPointer", 256, 8, NULL, NULL },
+    { "GuardEHContinuationTable", 264, 8, NULL, NULL },
+    { "GuardEHContinuationCount", 272, 8, NULL, NULL },
+};
+
+size_t schema_load_config_directory_pe32_plus_guard_flags_flags(vis_value_t value, char *buffer, size_t size)
+{
+    size_t pos = 0;
+    for (vis_value_t bits = value; bits; bits &= bits - 1) {
+        switch (bits & (~bits + 1))
+        {
+            case 0x100: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_INSTRUMENTED "); break;
+            case 0x200: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CFW_INSTRUMENTED "); break;
+            case 0x400: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_FUNCTION_TABLE_PRESENT "); break;
+            case 0x800: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_SECURITY_COOKIE_UNUSED "); break;
+            case 0x1000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_PROTECT_DELAYLOAD_IAT "); break;
+            case 0x2000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_DELAYLOAD_IAT_IN_ITS_OWN_SECTION "); break;
+            case 0x4000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_EXPORT_SUPPRESSION_INFO_PRESENT "); break;
+            case 0x8000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_ENABLE_EXPORT_SUPPRESSION "); break;
+            case 0x10000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_CF_LONGJUMP_TABLE_PRESENT "); break;
+            case 0x20000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RF_INSTRUMENTED "); break;
+            case 0x40000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RF_ENABLE "); break;
+            case 0x80000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RF_STRICT "); break;
+            case 0x100000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_RETPOLINE_PRESENT "); break;
+            case 0x400000: pos = vis_append_str(buffer, size, pos, "IMAGE_GUARD_EH_CONTINUATION_TABLE_PRESENT "); break;
+        }
+    }
+    if (pos == 0 && size > 0) {
+        buffer[0] = '\0';
+    }
+    return pos;
+}
+
+static const schema_struct_layout_t _layouts[] = {
+    { "COFF_File_Header", 20, 7, _layout_coff_file_header, _decode_coff_file_header },
+    { "Optional_Header(PE32)", 96, 30, _layout_optional_header_pe32, _decode_optional_header_pe32 },
+    { "Optional_Header(PE32+)", 112, 29, _layout_optional_header_pe32_plus, _decode_optional_header_pe32_plus },
+    { "Optional_Header_Data_Directory", 8, 2, _layout_optional_header_data_directory, _decode_optional_header_data_directory },
+    { "Section_Header", 40, 10, _layout_section_header, _decode_section_header },
+    { "COFF_Relocation(AMD64)", 10, 3, _layout_coff_relocation_amd64, _decode_coff_relocation_amd64 },
+    { "COFF_Relocation(ARM)", 10, 3, _layout_coff_relocation_arm, _decode_coff_relocation_arm },
+    { "COFF_Relocation(ARM64)", 10, 3, _layout_coff_relocation_arm64, _decode_coff_relocation_arm64 },
+    { "COFF_Relocation(SH3)", 10, 3, _layout_coff_relocation_sh3, _decode_coff_relocation_sh3 },
+    { "COFF_Relocation(PPC)", 10, 3, _layout_coff_relocation_ppc, _decode_coff_relocation_ppc },
+    { "COFF_Relocation(I386)", 10, 3, _layout_coff_relocation_i386, _decode_coff_relocation_i386 },
+    { "COFF_Relocation(IA64)", 10, 3, _layout_coff_relocation_ia64, _decode_coff_relocation_ia64 },
+    { "COFF_Relocation(MIPS)", 10, 3, _layout_coff_relocation_mips, _decode_coff_relocation_mips },
+    { "COFF_Relocation(M32R)", 10, 3, _layout_coff_relocation_m32r, _decode_coff_relocation_m32r },
+    { "TLS_Directory(PE32)", 24, 6, _layout_tls_directory_pe32, _decode_tls_directory_pe32 },
+    { "TLS_Directory(PE32+)", 40, 6, _layout_tls_directory_pe32_plus, _decode_tls_directory_pe32_plus },
+    { "Load_Config_Directory(PE32)", 172, 47, _layout_load_config_directory_pe32, _decode_load_config_directory_pe32 },
+    { "Load_Config_Directory(PE32+)", 280, 47, _layout_load_config_directory_pe32_plus, _decode_load_config_directory_pe32_plus },
+};
+
+// Attach generated decoders and value names to the loaded schema. Structures
+// whose layout differs from the generated one keep the interpretive decoder.
+void schema_gen_register()
+{
+    for (size_t i = 0; i < sizeof(_layouts) / sizeof(_layouts[0]); i++) {
+        const schema_struct_layout_t *layout = &_layouts[i];
+        vis_struct_t *st = vis_find_struct(layout->name);
+        if (!st || st->size != layout->size || st->fields.size != layout->field_num) {
+            continue;
+        }
+
+        bool same = true;
+        for (size_t j = 0; j < layout->field_num && same; j++) {
+            const vis_field_t *field = store_pget(&st->fields, j);
+            same = (field->offset == layout->fields[j].offset && field->size == layout->fields[j].size &&
+                strcmp(vis_str(field->name), layout->fields[j].name) == 0);
+        }
+        if (!same) {
+            continue;
+        }
+
+        st->decode = layout->decode;
+        for (size_t j = 0; j < layout->field_num; j++) {
+            vis_field_t *field = store_pget(&st->fields, j);
+            field->value_name = layout->fields[j].value_name;
+            field->flag_names = layout->fields[j].flag_names;
+        }
+    }
+}
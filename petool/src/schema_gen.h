@@ -0,0 +1,412 @@
+/**
+ * @file
+ *
+ * Decoders generated from petc schemas by "petool schema codegen". Do not edit.
+ */
+
+#ifndef SCHEMA_GEN_H
+#define SCHEMA_GEN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "vis_struct.h"
+
+// COFF_File_Header
+typedef struct schema_coff_file_header_t
+{
+    uint16_t Machine;
+    uint16_t NumberOfSections;
+    uint32_t TimeDateStamp;
+    uint32_t PointerToSymbolTable;
+    uint32_t NumberOfSymbols;
+    uint16_t SizeOfOptionalHeader;
+    uint16_t Characteristics;
+} schema_coff_file_header_t;
+
+#define SCHEMA_COFF_FILE_HEADER_SIZE 20
+
+bool schema_read_coff_file_header(const pe_image_t *image, size_t offset, schema_coff_file_header_t *record);
+const char * schema_coff_file_header_machine_name(vis_value_t value);
+size_t schema_coff_file_header_characteristics_flags(vis_value_t value, char *buffer, size_t size);
+
+// Optional_Header(PE32)
+typedef struct schema_optional_header_pe32_t
+{
+    uint16_t Magic;
+    uint8_t  MajorLinkerVersion;
+    uint8_t  MinorLinkerVersion;
+    uint32_t SizeOfCode;
+    uint32_t SizeOfInitializedData;
+    uint32_t SizeOfUninitializedData;
+    uint32_t AddressOfEntryPoint;
+    uint32_t BaseOfCode;
+    uint32_t BaseOfData;
+    uint32_t ImageBase;
+    uint32_t SectionAlignment;
+    uint32_t FileAlignment;
+    uint16_t MajorOperatingSystemVersion;
+    uint16_t MinorOperatingSystemVersion;
+    uint16_t MajorImageVersion;
+    uint16_t MinorImageVersion;
+    uint16_t MajorSubsystemVersion;
+    uint16_t MinorSubsystemVersion;
+    uint32_t Win32VersionValue;
+    uint32_t SizeOfImage;
+    uint32_t SizeOfHeaders;
+    uint32_t CheckSum;
+    uint16_t Subsystem;
+    uint16_t DllCharacteristics;
+    uint32_t SizeOfStackReserve;
+    uint32_t SizeOfStackCommit;
+    uint32_t SizeOfHeapReserve;
+    uint32_t SizeOfHeapCommit;
+    uint32_t LoaderFlags;
+    uint32_t NumberOfRvaAndSizes;
+} schema_optional_header_pe32_t;
+
+#define SCHEMA_OPTIONAL_HEADER_PE32_SIZE 96
+
+bool schema_read_optional_header_pe32(const pe_image_t *image, size_t offset, schema_optional_header_pe32_t *record);
+const char * schema_optional_header_pe32_subsystem_name(vis_value_t value);
+const char * schema_optional_header_pe32_dll_characteristics_name(vis_value_t value);
+
+// Optional_Header(PE32+)
+typedef struct schema_optional_header_pe32_plus_t
+{
+    uint16_t Magic;
+    uint8_t  MajorLinkerVersion;
+    uint8_t  MinorLinkerVersion;
+    uint32_t SizeOfCode;
+    uint32_t SizeOfInitializedData;
+    uint32_t SizeOfUninitializedData;
+    uint32_t AddressOfEntryPoint;
+    uint32_t BaseOfCode;
+    uint64_t ImageBase;
+    uint32_t SectionAlignment;
+    uint32_t FileAlignment;
+    uint16_t MajorOperatingSystemVersion;
+    uint16_t MinorOperatingSystemVersion;
+    uint16_t MajorImageVersion;
+    uint16_t MinorImageVersion;
+    uint16_t MajorSubsystemVersion;
+    uint16_t MinorSubsystemVersion;
+    uint32_t Win32VersionValue;
+    uint32_t SizeOfImage;
+    uint32_t SizeOfHeaders;
+    uint32_t CheckSum;
+    uint16_t Subsystem;
+    uint16_t DllCharacteristics;
+    uint64_t SizeOfStackReserve;
+    uint64_t SizeOfStackCommit;
+    uint64_t SizeOfHeapReserve;
+    uint64_t SizeOfHeapCommit;
+    uint32_t LoaderFlags;
+    uint32_t NumberOfRvaAndSizes;
+} schema_optional_header_pe32_plus_t;
+
+#define SCHEMA_OPTIONAL_HEADER_PE32_PLUS_SIZE 112
+
+bool schema_read_optional_header_pe32_plus(const pe_image_t *image, size_t offset, schema_optional_header_pe32_plus_t *record);
+const char * schema_optional_header_pe32_plus_subsystem_name(vis_value_t value);
+const char * schema_optional_header_pe32_plus_dll_characteristics_name(vis_value_t value);
+
+// Optional_Header_Data_Directory
+typedef struct schema_optional_header_data_directory_t
+{
+    uint32_t VirtualAddress;
+    uint32_t Size;
+} schema_optional_header_data_directory_t;
+
+#define SCHEMA_OPTIONAL_HEADER_DATA_DIRECTORY_SIZE 8
+
+bool schema_read_optional_header_data_directory(const pe_image_t *image, size_t offset, schema_optional_header_data_directory_t *record);
+
+// Section_Header
+typedef struct schema_section_header_t
+{
+    uint8_t  Name[8];
+    uint32_t VirtualSize;
+    uint32_t VirtualAddress;
+    uint32_t SizeOfRawData;
+    uint32_t PointerToRawData;
+    uint32_t PointerToRelocations;
+    uint32_t PointerToLinenumbers;
+    uint16_t NumberOfRelocations;
+    uint16_t NumberOfLinenumbers;
+    uint32_t Characteristics;
+} schema_section_header_t;
+
+#define SCHEMA_SECTION_HEADER_SIZE 40
+
+bool schema_read_section_header(const pe_image_t *image, size_t offset, schema_section_header_t *record);
+size_t schema_section_header_characteristics_flags(vis_value_t value, char *buffer, size_t size);
+
+// COFF_Relocation(AMD64)
+typedef struct schema_coff_relocation_amd64_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_amd64_t;
+
+#define SCHEMA_COFF_RELOCATION_AMD64_SIZE 10
+
+bool schema_read_coff_relocation_amd64(const pe_image_t *image, size_t offset, schema_coff_relocation_amd64_t *record);
+const char * schema_coff_relocation_amd64_type_name(vis_value_t value);
+
+// COFF_Relocation(ARM)
+typedef struct schema_coff_relocation_arm_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_arm_t;
+
+#define SCHEMA_COFF_RELOCATION_ARM_SIZE 10
+
+bool schema_read_coff_relocation_arm(const pe_image_t *image, size_t offset, schema_coff_relocation_arm_t *record);
+const char * schema_coff_relocation_arm_type_name(vis_value_t value);
+
+// COFF_Relocation(ARM64)
+typedef struct schema_coff_relocation_arm64_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_arm64_t;
+
+#define SCHEMA_COFF_RELOCATION_ARM64_SIZE 10
+
+bool schema_read_coff_relocation_arm64(const pe_image_t *image, size_t offset, schema_coff_relocation_arm64_t *record);
+const char * schema_coff_relocation_arm64_type_name(vis_value_t value);
+
+// COFF_Relocation(SH3)
+typedef struct schema_coff_relocation_sh3_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_sh3_t;
+
+#define SCHEMA_COFF_RELOCATION_SH3_SIZE 10
+
+bool schema_read_coff_relocation_sh3(const pe_image_t *image, size_t offset, schema_coff_relocation_sh3_t *record);
+const char * schema_coff_relocation_sh3_type_name(vis_value_t value);
+
+// COFF_Relocation(PPC)
+typedef struct schema_coff_relocation_ppc_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_ppc_t;
+
+#define SCHEMA_COFF_RELOCATION_PPC_SIZE 10
+
+bool schema_read_coff_relocation_ppc(const pe_image_t *image, size_t offset, schema_coff_relocation_ppc_t *record);
+const char * schema_coff_relocation_ppc_type_name(vis_value_t value);
+
+// COFF_Relocation(I386)
+typedef struct schema_coff_relocation_i386_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_i386_t;
+
+#define SCHEMA_COFF_RELOCATION_I386_SIZE 10
+
+bool schema_read_coff_relocation_i386(const pe_image_t *image, size_t offset, schema_coff_relocation_i386_t *record);
+const char * schema_coff_relocation_i386_type_name(vis_value_t value);
+
+// COFF_Relocation(IA64)
+typedef struct schema_coff_relocation_ia64_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_ia64_t;
+
+#define SCHEMA_COFF_RELOCATION_IA64_SIZE 10
+
+bool schema_read_coff_relocation_ia64(const pe_image_t *image, size_t offset, schema_coff_relocation_ia64_t *record);
+const char * schema_coff_relocation_ia64_type_name(vis_value_t value);
+
+// COFF_Relocation(MIPS)
+typedef struct schema_coff_relocation_mips_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_mips_t;
+
+#define SCHEMA_COFF_RELOCATION_MIPS_SIZE 10
+
+bool schema_read_coff_relocation_mips(const pe_image_t *image, size_t offset, schema_coff_relocation_mips_t *record);
+const char * schema_coff_relocation_mips_type_name(vis_value_t value);
+
+// COFF_Relocation(M32R)
+typedef struct schema_coff_relocation_m32r_t
+{
+    uint32_t VirtualAddress;
+    uint32_t SymbolTableIndex;
+    uint16_t Type;
+} schema_coff_relocation_m32r_t;
+
+#define SCHEMA_COFF_RELOCATION_M32R_SIZE 10
+
+bool schema_read_coff_relocation_m32r(const pe_image_t *image, size_t offset, schema_coff_relocation_m32r_t *record);
+const char * schema_coff_relocation_m32r_type_name(vis_value_t value);
+
+// TLS_Directory(PE32)
+typedef struct schema_tls_directory_pe32_t
+{
+    uint32_t RawDataStartVA;
+    uint32_t RawDataEndVA;
+    uint32_t AddressOfIndex;
+    uint32_t AddressOfCallbacks;
+    uint32_t SizeOfZeroFill;
+    uint32_t Characteristics;
+} schema_tls_directory_pe32_t;
+
+#define SCHEMA_TLS_DIRECTORY_PE32_SIZE 24
+
+bool schema_read_tls_directory_pe32(const pe_image_t *image, size_t offset, schema_tls_directory_pe32_t *record);
+
+// TLS_Directory(PE32+)
+typedef struct schema_tls_directory_pe32_plus_t
+{
+    uint64_t RawDataStartVA;
+    uint64_t RawDataEndVA;
+    uint64_t AddressOfIndex;
+    uint64_t AddressOfCallbacks;
+    uint32_t SizeOfZeroFill;
+    uint32_t Characteristics;
+} schema_tls_directory_pe32_plus_t;
+
+#define SCHEMA_TLS_DIRECTORY_PE32_PLUS_SIZE 40
+
+bool schema_read_tls_directory_pe32_plus(const pe_image_t *image, size_t offset, schema_tls_directory_pe32_plus_t *record);
+
+// Load_Config_Directory(PE32)
+typedef struct schema_load_config_directory_pe32_t
+{
+    uint32_t Size;
+    uint32_t TimeDateStamp;
+    uint16_t MajorVersion;
+    uint16_t MinorVersion;
+    uint32_t GlobalFlagsClear;
+    uint32_t GlobalFlagsSet;
+    uint32_t CriticalSectionDefaultTimeout;
+    uint32_t DeCommitFreeBlockThreshold;
+    uint32_t DeCommitTotalFreeThreshold;
+    uint32_t LockPrefixTable;
+    uint32_t MaximumAllocationSize;
+    uint32_t VirtualMemoryThreshold;
+    uint32_t ProcessHeapFlags;
+    uint32_t ProcessAffinityMask;
+    uint16_t CSDVersion;
+    uint16_t DependentLoadFlags;
+    uint32_t EditList;
+    uint32_t SecurityCookie;
+    uint32_t SEHandlerTable;
+    uint32_t SEHandlerCount;
+    uint32_t GuardCFCheckFunctionPointer;
+    uint32_t GuardCFDispatchFunctionPointer;
+    uint32_t GuardCFFunctionTable;
+    uint32_t GuardCFFunctionCount;
+    uint32_t GuardFlags;
+    uint16_t CodeIntegrityFlags;
+    uint16_t CodeIntegrityCatalog;
+    uint32_t CodeIntegrityCatalogOffset;
+    uint32_t CodeIntegrityReserved;
+    uint32_t GuardAddressTakenIatEntryTable;
+    uint32_t GuardAddressTakenIatEntryCount;
+    uint32_t GuardLongJumpTargetTable;
+    uint32_t GuardLongJumpTargetCount;
+    uint32_t DynamicValueRelocTable;
+    uint32_t CHPEMetadataPointer;
+    uint32_t GuardRFFailureRoutine;
+    uint32_t GuardRFFailureRoutineFunctionPointer;
+    uint32_t DynamicValueRelocTableOffset;
+    uint16_t DynamicValueRelocTableSection;
+    uint16_t Reserved2;
+    uint32_t GuardRFVerifyStackPointerFunctionPointer;
+    uint32_t HotPatchTableOffset;
+    uint32_t Reserved3;
+    uint32_t EnclaveConfigurationPointer;
+    uint32_t VolatileMetadataPointer;
+    uint32_t GuardEHContinuationTable;
+    uint32_t GuardEHContinuationCount;
+} schema_load_config_directory_pe32_t;
+
+#define SCHEMA_LOAD_CONFIG_DIRECTORY_PE32_SIZE 172
+
+bool schema_read_load_config_directory_pe32(const pe_image_t *image, size_t offset, schema_load_config_directory_pe32_t *record);
+size_t schema_load_config_directory_pe32_guard_flags_flags(vis_value_t value, char *buffer, size_t size);
+
+// Load_Config_Directory(PE32+)
+typedef struct schema_load_config_directory_pe32_plus_t
+{
+    uint32_t Size;
+    uint32_t TimeDateStamp;
+    uint16_t MajorVersion;
+    uint16_t MinorVersion;
+    uint32_t GlobalFlagsClear;
+    uint32_t GlobalFlagsSet;
+    uint32_t CriticalSectionDefaultTimeout;
+    uint64_t DeCommitFreeBlockThreshold;
+    uint64_t DeCommitTotalFreeThreshold;
+    uint64_t LockPrefixTable;
+    uint64_t MaximumAllocationSize;
+    uint64_t VirtualMemoryThreshold;
+    uint64_t ProcessAffinityMask;
+    uint32_t ProcessHeapFlags;
+    uint16_t CSDVersion;
+    uint16_t DependentLoadFlags;
+    uint64_t EditList;
+    uint64_t SecurityCookie;
+    uint64_t SEHandlerTable;
+    uint64_t SEHandlerCount;
+    uint64_t GuardCFCheckFunctionPointer;
+    uint64_t GuardCFDispatchFunctionPointer;
+    uint64_t GuardCFFunctionTable;
+    uint64_t GuardCFFunctionCount;
+    uint32_t GuardFlags;
+    uint16_t CodeIntegrityFlags;
+    uint16_t CodeIntegrityCatalog;
+    uint32_t CodeIntegrityCatalogOffset;
+    uint32_t CodeIntegrityReserved;
+    uint64_t GuardAddressTakenIatEntryTable;
+    uint64_t GuardAddressTakenIatEntryCount;
+    uint64_t GuardLongJumpTargetTable;
+    uint64_t GuardLongJumpTargetCount;
+    uint64_t DynamicValueRelocTable;
+    uint64_t CHPEMetadataPointer;
+    uint64_t GuardRFFailureRoutine;
+    uint64_t GuardRFFailureRoutineFunctionPointer;
+    uint32_t DynamicValueRelocTableOffset;
+    uint16_t DynamicValueRelocTableSection;
+    uint16_t Reserved2;
+    uint64_t GuardRFVerifyStackPointerFunctionPointer;
+    uint32_t HotPatchTableOffset;
+    uint32_t Reserved3;
+    uint64_t EnclaveConfigurationPointer;
+    uint64_t VolatileMetadataPointer;
+    uint64_t GuardEHContinuationTable;
+    uint64_t GuardEHContinuationCount;
+} schema_load_config_directory_pe32_plus_t;
+
+#define SCHEMA_LOAD_CONFIG_DIRECTORY_PE32_PLUS_SIZE 280
+
+bool schema_read_load_config_directory_pe32_plus(const pe_image_t *image, size_t offset, schema_load_config_directory_pe32_plus_t *record);
+size_t schema_load_config_directory_pe32_plus_guard_flags_flags(vis_value_t value, char *buffer, size_t size);
+
+// Regenerate after editing std/*.petc: the project build runs "petool schema
+// codegen" with the petool of the previous build, or run it by hand with the
+// petc files in the order main.c loads them.
+void schema_gen_register();
+
+#endif
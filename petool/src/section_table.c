@@ -0,0 +1,284 @@
+#include <stdlib.h>
+#include <string.h>
+#include "section_table.h"
+#include "error.h"
+
+// Offsets of fields shared by PE32 and PE32+ optional headers
+#define OPTIONAL_FILE_ALIGNMENT_OFFSET 36
+#define OPTIONAL_SIZE_OF_HEADERS_OFFSET 60
+
+// Raw data pointers of images with at least this file alignment are rounded
+// down to it by the loader
+#define MIN_LOADER_FILE_ALIGNMENT 0x200
+
+// Address range a section or the headers claim, before overlaps are resolved.
+// Where ranges overlap, the lowest priority number wins: sections in table
+// order, then the headers.
+typedef struct
+{
+    uint64_t start;
+    uint64_t end;
+    uint64_t file_end;
+    uint64_t offset;
+    uint32_t section;
+    uint32_t priority;
+} rva_range_t;
+
+static int _cmp_range_start(const void *a, const void *b)
+{
+    const rva_range_t *ra = a;
+    const rva_range_t *rb = b;
+    return (ra->start > rb->start) - (ra->start < rb->start);
+}
+
+static int _cmp_u64(const void *a, const void *b)
+{
+    uint64_t va = *(const uint64_t *)a;
+    uint64_t vb = *(const uint64_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+// Min-heap of range indices ordered by priority
+static void _heap_push(size_t *heap, size_t *size, const rva_range_t *ranges, size_t idx)
+{
+    size_t pos = (*size)++;
+    while (pos > 0 && ranges[heap[(pos - 1) / 2]].priority > ranges[idx].priority) {
+        heap[pos] = heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    heap[pos] = idx;
+}
+
+static void _heap_pop(size_t *heap, size_t *size, const rva_range_t *ranges)
+{
+    size_t last = heap[--(*size)];
+    size_t pos = 0;
+    for (;;) {
+        size_t child = 2 * pos + 1;
+        if (child >= *size) {
+            break;
+        }
+        if (child + 1 < *size && ranges[heap[child + 1]].priority < ranges[heap[child]].priority) {
+            child++;
+        }
+        if (ranges[heap[child]].priority >= ranges[last].priority) {
+            break;
+        }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    heap[pos] = last;
+}
+
+// Append the part [start, end) of a range to the intervals, merging it with
+// the previous interval if that one is the preceding part of the same range
+static void _add_interval(section_table_t *table, const rva_range_t *range, uint64_t start, uint64_t end)
+{
+    rva_interval_t *last = table->interval_num ? &table->intervals[table->interval_num - 1] : NULL;
+    if (last && last->end == start && last->section == range->section &&
+            last->offset + (start - last->start) == range->offset + (start - range->start)) {
+        last->end = end;
+    } else {
+        last = &table->intervals[table->interval_num++];
+        last->start = (uint32_t)start;
+        last->section = range->section;
+        last->end = end;
+        last->offset = range->offset + (start - range->start);
+    }
+
+    uint64_t file_end = (range->file_end < last->end) ? range->file_end : last->end;
+    last->file_end = (file_end > last->start) ? file_end : last->start;
+}
+
+// Resolve overlapping ranges into disjoint intervals sorted by start. Sweeps
+// over all range boundaries, keeping the ranges that cover the current point
+// in a heap by priority.
+static void _build_intervals(section_table_t *table, rva_range_t *ranges, size_t range_num)
+{
+    qsort(ranges, range_num, sizeof(rva_range_t), _cmp_range_start);
+
+    uint64_t *bounds = malloc(sizeof(uint64_t) * (2 * range_num + 1));
+    size_t bound_num = 0;
+    for (size_t i = 0; i < range_num; i++) {
+        bounds[bound_num++] = ranges[i].start;
+        bounds[bound_num++] = ranges[i].end;
+    }
+    qsort(bounds, bound_num, sizeof(uint64_t), _cmp_u64);
+
+    size_t *heap = malloc(sizeof(size_t) * (range_num + 1));
+    size_t heap_size = 0;
+    size_t next = 0;
+
+    // Every elementary segment starts at most one interval
+    table->intervals = malloc(sizeof(rva_interval_t) * (bound_num + 1));
+    table->interval_num = 0;
+
+    for (size_t k = 0; k + 1 < bound_num; k++) {
+        uint64_t start = bounds[k];
+        uint64_t end = bounds[k + 1];
+        if (start > UINT32_MAX) {
+            break;
+        }
+        if (start == end) {
+            continue;
+        }
+
+        while (next < range_num && ranges[next].start <= start) {
+            _heap_push(heap, &heap_size, ranges, next++);
+        }
+        while (heap_size > 0 && ranges[heap[0]].end <= start) {
+            _heap_pop(heap, &heap_size, ranges);
+        }
+        if (heap_size > 0) {
+            _add_interval(table, &ranges[heap[0]], start, end);
+        }
+    }
+
+    free(heap);
+    free(bounds);
+}
+
+// Decode the section table that follows the optional header and index the
+// address ranges of sections and headers
+bool read_section_table(const pe_image_t *image, size_t coff_offset, const coff_file_header_t *coff, section_table_t *table)
+{
+    memset(table, 0, sizeof(section_table_t));
+
+    size_t optional_offset = coff_offset + COFF_FILE_HEADER_SIZE;
+    size_t table_offset = optional_offset + coff->SizeOfOptionalHeader;
+    size_t header_num = coff->NumberOfSections;
+    const uint8_t *data = image_ptr(image, table_offset, header_num * SECTION_HEADER_SIZE);
+    if (!data) {
+        set_error("Section table is truncated");
+        return false;
+    }
+
+    uint32_t file_alignment = 0;
+    uint32_t size_of_headers = 0;
+    if (coff->SizeOfOptionalHeader >= OPTIONAL_FILE_ALIGNMENT_OFFSET + 4) {
+        image_read_u32(image, optional_offset + OPTIONAL_FILE_ALIGNMENT_OFFSET, &file_alignment);
+    }
+    if (coff->SizeOfOptionalHeader >= OPTIONAL_SIZE_OF_HEADERS_OFFSET + 4) {
+        image_read_u32(image, optional_offset + OPTIONAL_SIZE_OF_HEADERS_OFFSET, &size_of_headers);
+    }
+
+    table->headers = malloc(sizeof(section_header_t) * (header_num ? header_num : 1));
+    table->header_num = header_num;
+    rva_range_t *ranges = malloc(sizeof(rva_range_t) * (header_num + 1));
+    size_t range_num = 0;
+
+    for (size_t i = 0; i < header_num; i++) {
+        section_header_t *sh = &table->headers[i];
+        memcpy(sh, data + i * SECTION_HEADER_SIZE, SECTION_HEADER_SIZE);
+
+        // Like the loader, take the raw size for a missing virtual size and
+        // zero-fill what is not backed by the file
+        uint64_t virtual_size = sh->VirtualSize ? sh->VirtualSize : sh->SizeOfRawData;
+        if (virtual_size == 0) {
+            continue;
+        }
+
+        uint64_t raw_offset = sh->PointerToRawData;
+        if (file_alignment >= MIN_LOADER_FILE_ALIGNMENT) {
+            raw_offset &= ~(uint64_t)(MIN_LOADER_FILE_ALIGNMENT - 1);
+        }
+        uint64_t raw_size = (sh->SizeOfRawData < virtual_size) ? sh->SizeOfRawData : virtual_size;
+        if (sh->PointerToRawData == 0 || raw_offset >= image->size) {
+            raw_size = 0;
+        } else if (raw_size > image->size - raw_offset) {
+            raw_size = image->size - raw_offset;
+        }
+
+        rva_range_t *range = &ranges[range_num++];
+        range->start = sh->VirtualAddress;
+        range->end = range->start + virtual_size;
+        range->file_end = range->start + raw_size;
+        range->offset = raw_offset;
+        range->section = (uint32_t)i;
+        range->priority = (uint32_t)i;
+    }
+
+    // Headers map to the same offsets, where no section covers them
+    if (size_of_headers > 0) {
+        rva_range_t *range = &ranges[range_num++];
+        range->start = 0;
+        range->end = size_of_headers;
+        range->file_end = (size_of_headers < image->size) ? size_of_headers : image->size;
+        range->offset = 0;
+        range->section = SECTION_HEADERS;
+        range->priority = (uint32_t)header_num;
+    }
+
+    _build_intervals(table, ranges, range_num);
+    free(ranges);
+    return true;
+}
+
+void section_table_free(section_table_t *table)
+{
+    free(table->headers);
+    free(table->intervals);
+    memset(table, 0, sizeof(section_table_t));
+}
+
+// Find the interval containing an RVA, NULL if no section maps it
+const rva_interval_t * rva_find_interval(const section_table_t *table, uint32_t rva)
+{
+    size_t n = table->interval_num;
+    if (n == 0) {
+        return NULL;
+    }
+
+    // Last interval starting at or before rva; the loop body compiles to a
+    // conditional move
+    const rva_interval_t *base = table->intervals;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = (base[half].start <= rva) ? base + half : base;
+        n -= half;
+    }
+
+    return (base->start <= rva && rva < base->end) ? base : NULL;
+}
+
+// Translate an RVA to a file offset. Fails for RVAs outside all sections and
+// for zero-filled parts of sections, which have no file data.
+bool rva_to_offset(const section_table_t *table, uint32_t rva, size_t *offset)
+{
+    const rva_interval_t *iv = rva_find_interval(table, rva);
+    if (!iv || rva >= iv->file_end) {
+        return false;
+    }
+    *offset = (size_t)(iv->offset + (rva - iv->start));
+    return true;
+}
+
+// Pointer to size bytes of file data at an RVA, NULL unless all of them are
+// backed by the file within one interval
+const void * rva_ptr(const pe_image_t *image, const section_table_t *table, uint32_t rva, size_t size)
+{
+    const rva_interval_t *iv = rva_find_interval(table, rva);
+    if (!iv || (uint64_t)rva + size > iv->file_end) {
+        return NULL;
+    }
+    return image_ptr(image, (size_t)(iv->offset + (rva - iv->start)), size);
+}
+
+// Pointer to a NUL-terminated string at an RVA without copying it. NULL unless
+// the terminator is backed by the file within the same interval.
+const char * rva_str(const pe_image_t *image, const section_table_t *table, uint32_t rva, size_t *len)
+{
+    const rva_interval_t *iv = rva_find_interval(table, rva);
+    if (!iv || rva >= iv->file_end) {
+        return NULL;
+    }
+    size_t offset = (size_t)(iv->offset + (rva - iv->start));
+    size_t avail = (size_t)(iv->file_end - rva);
+    const char *str = image_ptr(image, offset, avail);
+    const char *nul = str ? memchr(str, '\0', avail) : NULL;
+    if (!nul) {
+        return NULL;
+    }
+    *len = (size_t)(nul - str);
+    return str;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file
+ *
+ * Section table and translation of RVAs to file offsets. The table is decoded
+ * once per image into an array of disjoint RVA intervals sorted by start, so
+ * every lookup is a branchless binary search.
+ */
+
+#ifndef SECTION_TABLE_H
+#define SECTION_TABLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "coff_header.h"
+
+#define SECTION_HEADER_SIZE 40
+
+// Section Header, an entry of the section table that follows the optional header
+typedef struct {
+    uint8_t Name[8];
+
+    //union {
+    //        DWORD   PhysicalAddress;
+    //        DWORD   VirtualSize;
+    //} Misc;
+    uint32_t VirtualSize;
+
+    uint32_t VirtualAddress;
+    uint32_t SizeOfRawData;
+    uint32_t PointerToRawData;
+    uint32_t PointerToRelocations;
+    uint32_t PointerToLinenumbers;
+    uint16_t NumberOfRelocations;
+    uint16_t NumberOfLinenumbers;
+    uint32_t Characteristics;
+} section_header_t;
+
+// Section characteristics
+typedef enum {
+    //      IMAGE_SCN_TYPE_REG                   0x00000000  // Reserved.
+    //      IMAGE_SCN_TYPE_DSECT                 0x00000001  // Reserved.
+    //      IMAGE_SCN_TYPE_NOLOAD                0x00000002  // Reserved.
+    //      IMAGE_SCN_TYPE_GROUP                 0x00000004  // Reserved.
+    IMAGE_SCN_TYPE_NO_PAD =               0x00000008,  // Reserved.
+    //      IMAGE_SCN_TYPE_COPY                  0x00000010  // Reserved.
+
+    IMAGE_SCN_CNT_CODE =                  0x00000020,  // Section contains code.
+    IMAGE_SCN_CNT_INITIALIZED_DATA =      0x00000040,  // Section contains initialized data.
+    IMAGE_SCN_CNT_UNINITIALIZED_DATA =    0x00000080,  // Section contains uninitialized data.
+
+    IMAGE_SCN_LNK_OTHER =                 0x00000100,  // Reserved.
+    IMAGE_SCN_LNK_INFO =                  0x00000200,  // Section contains comments or some other type of information.
+    //      IMAGE_SCN_TYPE_OVER                  0x00000400  // Reserved.
+    IMAGE_SCN_LNK_REMOVE =                0x00000800,  // Section contents will not become part of image.
+    IMAGE_SCN_LNK_COMDAT =                0x00001000,  // Section contents comdat.
+    //                                           0x00002000  // Reserved.
+    //      IMAGE_SCN_MEM_PROTECTED - Obsolete   0x00004000
+    //IMAGE_SCN_NO_DEFER_SPEC_EXC =         0x00004000,  // Reset speculative exceptions handling bits in the TLB entries for this section.
+    IMAGE_SCN_GPREL =                     0x00008000,  // Section content can be accessed relative to GP
+    //IMAGE_SCN_MEM_FARDATA =               0x00008000,
+    //      IMAGE_SCN_MEM_SYSHEAP  - Obsolete    0x00010000
+    IMAGE_SCN_MEM_PURGEABLE =             0x00020000,
+    IMAGE_SCN_MEM_16BIT =                 0x00020000,
+    IMAGE_SCN_MEM_LOCKED =                0x00040000,
+    IMAGE_SCN_MEM_PRELOAD =               0x00080000,
+
+    IMAGE_SCN_ALIGN_1BYTES =              0x00100000,  //
+    IMAGE_SCN_ALIGN_2BYTES =              0x00200000,  //
+    IMAGE_SCN_ALIGN_4BYTES =              0x00300000,  //
+    IMAGE_SCN_ALIGN_8BYTES =              0x00400000,  //
+    IMAGE_SCN_ALIGN_16BYTES =             0x00500000,  // Default alignment if no others are specified.
+    IMAGE_SCN_ALIGN_32BYTES =             0x00600000,  //
+    IMAGE_SCN_ALIGN_64BYTES =             0x00700000,  //
+    IMAGE_SCN_ALIGN_128BYTES =            0x00800000,  //
+    IMAGE_SCN_ALIGN_256BYTES =            0x00900000,  //
+    IMAGE_SCN_ALIGN_512BYTES =            0x00A00000,  //
+    IMAGE_SCN_ALIGN_1024BYTES =           0x00B00000,  //
+    IMAGE_SCN_ALIGN_2048BYTES =           0x00C00000,  //
+    IMAGE_SCN_ALIGN_4096BYTES =           0x00D00000,  //
+    IMAGE_SCN_ALIGN_8192BYTES =           0x00E00000,  //
+    // Unused                                    0x00F00000
+    //IMAGE_SCN_ALIGN_MASK =                0x00F00000,
+
+    IMAGE_SCN_LNK_NRELOC_OVFL =           0x01000000,  // Section contains extended relocations.
+    IMAGE_SCN_MEM_DISCARDABLE =           0x02000000,  // Section can be discarded.
+    IMAGE_SCN_MEM_NOT_CACHED =            0x04000000,  // Section is not cachable.
+    IMAGE_SCN_MEM_NOT_PAGED =             0x08000000,  // Section is not pageable.
+    IMAGE_SCN_MEM_SHARED =                0x10000000,  // Section is shareable.
+    IMAGE_SCN_MEM_EXECUTE =               0x20000000,  // Section is executable.
+    IMAGE_SCN_MEM_READ =                  0x40000000,  // Section is readable.
+    IMAGE_SCN_MEM_WRITE =                 0x80000000,  // Section is writeable.
+} section_flags_t;
+
+// Part of the address space backed by one section or by the headers
+typedef struct
+{
+    uint32_t start;             // first RVA
+    uint32_t section;           // index of section, SECTION_HEADERS for the headers
+    uint64_t end;               // RVA after the interval
+    uint64_t file_end;          // RVA where file data ends, the rest up to end is zero-filled
+    uint64_t offset;            // file offset of start
+} rva_interval_t;
+
+#define SECTION_HEADERS UINT32_MAX
+
+typedef struct
+{
+    section_header_t *headers;
+    size_t            header_num;
+    rva_interval_t   *intervals;
+    size_t            interval_num;
+} section_table_t;
+
+bool read_section_table(const pe_image_t *image, size_t coff_offset, const coff_file_header_t *coff, section_table_t *table);
+void section_table_free(section_table_t *table);
+
+const rva_interval_t * rva_find_interval(const section_table_t *table, uint32_t rva);
+bool rva_to_offset(const section_table_t *table, uint32_t rva, size_t *offset);
+const void * rva_ptr(const pe_image_t *image, const section_table_t *table, uint32_t rva, size_t size);
+const char * rva_str(const pe_image_t *image, const section_table_t *table, uint32_t rva, size_t *len);
+
+#endif
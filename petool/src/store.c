@@ -10,27 +10,49 @@ void store_create_by_size(store_t *store, size_t elsize)
     store->cap = 0;
 }
 
-void store_add(store_t *store, void *value)
+// Make room for n more elements. A store with data but no capacity borrows
+// memory it does not own, such as a mapped schema cache, and is copied to the
+// heap before it grows.
+static void _reserve(store_t *store, size_t n)
 {
-    if (store->size == store->cap) {
-        store->cap = store->cap * 2 + 1;
+    if (store->size + n <= store->cap) {
+        return;
+    }
+    if (store->cap == 0 && store->data) {
+        size_t cap = store->size * 2 + n;
+        void *data = malloc(store->elsize * cap);
+        memcpy(data, store->data, store->elsize * store->size);
+        store->data = data;
+        store->cap = cap;
+    } else {
+        store->cap = store->cap * 2 + n;
         store->data = realloc(store->data, store->elsize * store->cap);
     }
+}
+
+void store_add(store_t *store, void *value)
+{
+    _reserve(store, 1);
     memcpy((char *)store->data + store->elsize * store->size, value, store->elsize);
     store->size++;
 }
 
 void * store_alloc(store_t *store)
 {
-    if (store->size == store->cap) {
-        store->cap = store->cap * 2 + 1;
-        store->data = realloc(store->data, store->elsize * store->cap);
-    }
+    _reserve(store, 1);
     store->size++;
     return (char *)store->data + store->elsize * (store->size - 1);
 }
 
-void * store_pget(store_t *store, size_t idx)
+// Allocate n consecutive elements at the end of store
+void * store_alloc_n(store_t *store, size_t n)
+{
+    _reserve(store, n);
+    store->size += n;
+    return (char *)store->data + store->elsize * (store->size - n);
+}
+
+void * store_pget(const store_t *store, size_t idx)
 {
     return (char *)store->data + store->elsize * idx;
 }
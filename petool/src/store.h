@@ -9,7 +9,7 @@ typedef struct
     void *data;
     size_t elsize;
     size_t size;
-    size_t cap;
+    size_t cap;     // 0 with data set: borrowed read-only data, copied before it grows
 } store_t;
 
 #define store_init(TYPE) { NULL, sizeof(TYPE), 0, 0 }
@@ -21,6 +21,7 @@ void store_create_by_size(store_t *store, size_t elsize);
 void store_add(store_t *store, void *value);
 
 void * store_alloc(store_t *store);
+void * store_alloc_n(store_t *store, size_t n);
 
 typedef struct
 {
@@ -28,6 +29,6 @@ typedef struct
     void *p;
 } store_iter_t;
 
-void * store_pget(store_t *store, size_t idx);
+void * store_pget(const store_t *store, size_t idx);
 
 #endif
@@ -0,0 +1,44 @@
+#include <stdlib.h>
+#include <string.h>
+#include "str_arena.h"
+
+static const char * _arena_str(const void *ctx, size_t offset)
+{
+    const str_arena_t *arena = ctx;
+    return (const char *)arena->chars.data + offset;
+}
+
+// Intern a string of len characters. Returns reference to the stored copy,
+// which is shared with all equal strings.
+str_ref_t str_intern(str_arena_t *arena, const char *str, size_t len)
+{
+    size_t offset;
+    if (name_index_find(&arena->index, str, len, _arena_str, arena, &offset)) {
+        str_ref_t ref = { (uint32_t)offset, (uint32_t)len };
+        return ref;
+    }
+
+    offset = arena->chars.size;
+    char *dest = store_alloc_n(&arena->chars, len + 1);
+    memcpy(dest, str, len);
+    dest[len] = '\0';
+    name_index_add(&arena->index, dest, len, offset);
+
+    str_ref_t ref = { (uint32_t)offset, (uint32_t)len };
+    return ref;
+}
+
+// Get interned string. The pointer is valid until more strings are interned.
+const char * str_get(const str_arena_t *arena, str_ref_t ref)
+{
+    return (const char *)arena->chars.data + ref.offset;
+}
+
+void str_arena_free(str_arena_t *arena)
+{
+    if (arena->chars.cap) {
+        free(arena->chars.data);
+    }
+    store_create(&arena->chars, char);
+    name_index_free(&arena->index);
+}
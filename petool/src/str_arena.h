@@ -0,0 +1,35 @@
+/**
+ * @file
+ *
+ * Arena of interned strings. All strings live in one contiguous buffer and are
+ * referenced by offset and length, so equal strings are stored once and
+ * structures referring to them stay small.
+ */
+
+#ifndef STR_ARENA_H
+#define STR_ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "store.h"
+#include "name_index.h"
+
+typedef struct str_ref_t
+{
+    uint32_t offset;
+    uint32_t len;
+} str_ref_t;
+
+typedef struct str_arena_t
+{
+    store_t      chars;         // NUL-terminated strings, back to back
+    name_index_t index;         // offset of every interned string
+} str_arena_t;
+
+#define str_arena_init() { store_init(char), name_index_init() }
+
+str_ref_t str_intern(str_arena_t *arena, const char *str, size_t len);
+const char * str_get(const str_arena_t *arena, str_ref_t ref);
+void str_arena_free(str_arena_t *arena);
+
+#endif
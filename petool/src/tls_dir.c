@@ -0,0 +1,77 @@
+#include <string.h>
+#include "tls_dir.h"
+#include "error.h"
+
+// Decode the TLS directory. Fails without an error set if the image has no
+// TLS directory.
+bool read_tls_directory(const pe_headers_t *pe, tls_directory_t *tls)
+{
+    memset(tls, 0, sizeof(tls_directory_t));
+    tls->pe32_plus = (pe->optional.magic == OPTIONAL_HEADER_MAGIC_PE32_PLUS);
+
+    data_directory_t dir;
+    if (!pe_data_dir(pe, DATA_DIR_TLS_TABLE, &dir)) {
+        return false;
+    }
+
+    size_t offset;
+    if (!rva_to_offset(&pe->sections, dir.VirtualAddress, &offset)) {
+        set_error("TLS directory is out of image");
+        return false;
+    }
+    if (tls->pe32_plus) {
+        return schema_read_tls_directory_pe32_plus(pe->image, offset, &tls->dir.pe32_plus);
+    }
+    return schema_read_tls_directory_pe32(pe->image, offset, &tls->dir.pe32);
+}
+
+// Start iteration over the callbacks. A directory without a callback array
+// yields none.
+void tls_callback_iter_init(tls_callback_iter_t *it, const pe_headers_t *pe, const tls_directory_t *tls)
+{
+    it->pe = pe;
+    it->rva = 0;
+    it->done = true;
+
+    uint64_t va = TLS_FIELD(tls, AddressOfCallbacks);
+    if (va == 0) {
+        return;
+    }
+    if (!pe_va_to_rva(pe, va, &it->rva)) {
+        set_error("TLS callback array is out of image");
+        return;
+    }
+    it->done = false;
+}
+
+// Get the RVA of the next callback. Returns false after the last one, and
+// also with an error set if the array is damaged.
+bool tls_next_callback(tls_callback_iter_t *it, uint32_t *rva)
+{
+    if (it->done) {
+        return false;
+    }
+
+    const pe_headers_t *pe = it->pe;
+    size_t addr_size = pe_addr_size(pe);
+    const uint8_t *data = rva_ptr(pe->image, &pe->sections, it->rva, addr_size);
+    if (!data) {
+        it->done = true;
+        set_error("TLS callback array is out of image");
+        return false;
+    }
+
+    uint64_t va = 0;
+    memcpy(&va, data, addr_size);
+    if (va == 0) {
+        it->done = true;
+        return false;
+    }
+    if (!pe_va_to_rva(pe, va, rva)) {
+        it->done = true;
+        set_error("TLS callback is out of image");
+        return false;
+    }
+    it->rva += (uint32_t)addr_size;
+    return true;
+}
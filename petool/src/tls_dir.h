@@ -0,0 +1,46 @@
+/**
+ * @file
+ *
+ * TLS directory decoder. The directory is decoded by the generated reader of
+ * the image format, and the null-terminated callback array is walked lazily.
+ */
+
+#ifndef TLS_DIR_H
+#define TLS_DIR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "image.h"
+#include "pe_headers.h"
+#include "schema_gen.h"
+
+// TLS directory of either image format
+typedef struct
+{
+    bool pe32_plus;
+    union
+    {
+        schema_tls_directory_pe32_t      pe32;
+        schema_tls_directory_pe32_plus_t pe32_plus;
+    } dir;
+} tls_directory_t;
+
+// Value of a field of either format, address-sized fields widened to 64 bits
+#define TLS_FIELD(tls, field) \
+    ((tls)->pe32_plus ? (uint64_t)(tls)->dir.pe32_plus.field : (uint64_t)(tls)->dir.pe32.field)
+
+// Position in the array of TLS callback VAs
+typedef struct
+{
+    const pe_headers_t *pe;
+    uint32_t            rva;        // next array element
+    bool                done;
+} tls_callback_iter_t;
+
+bool read_tls_directory(const pe_headers_t *pe, tls_directory_t *tls);
+
+void tls_callback_iter_init(tls_callback_iter_t *it, const pe_headers_t *pe, const tls_directory_t *tls);
+bool tls_next_callback(tls_callback_iter_t *it, uint32_t *rva);
+
+#endif
@@ -1,102 +1,207 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <string.h>
 #include <assert.h>
 #include <time.h>
 #include "vis_struct.h"
+#include "compat.h"
 
-#define MAX_VALUE_STR_LEN 5000
+// Currently existing visual structures, with names and descriptions of all
+// structures, fields and values
+static vis_schema_t schema = { store_init(vis_struct_t), name_index_init(), str_arena_init() };
 
-// Currently existing visual structures
-static store_t structs = store_init(vis_struct_t);
+vis_schema_t * vis_schema()
+{
+    return &schema;
+}
+
+// Get a schema string. The pointer is valid until the schema is extended.
+const char * vis_str(str_ref_t ref)
+{
+    return str_get(&schema.strings, ref);
+}
+
+static const char * _struct_name(const void *ctx, size_t idx)
+{
+    (void)ctx;
+    const vis_struct_t *st = store_pget(&schema.structs, idx);
+    return vis_str(st->name);
+}
+
+static const char * _field_name(const void *ctx, size_t idx)
+{
+    const vis_field_t *field = store_pget(&((const vis_struct_t *)ctx)->fields, idx);
+    return vis_str(field->name);
+}
 
 // Create a new visual structure
 vis_struct_t * vis_create_struct(const char *name)
 {
-    vis_struct_t * st = store_alloc(&structs);
-    strncpy_s(st->name, MAX_NAME_LEN + 1, name, MAX_NAME_LEN);
+    vis_struct_t * st = store_alloc(&schema.structs);
+    st->name = str_intern(&schema.strings, name, strlen(name));
+    st->size = 0;
     store_create(&st->fields, vis_field_t);
+    st->field_index = (name_index_t)name_index_init();
+    st->decode = NULL;
+    name_index_add(&schema.struct_index, name, st->name.len, schema.structs.size - 1);
     return st;
 }
 
 // Find a visual structure by its name
 vis_struct_t * vis_find_struct(const char *name)
 {
-    for (size_t i = 0; i < structs.size; i++) {
-        vis_struct_t *st = store_pget(&structs, i);
-        if (strcmp(st->name, name) == 0) {
-            return st;
-        }
+    size_t idx;
+    if (name_index_find(&schema.struct_index, name, strlen(name), _struct_name, NULL, &idx)) {
+        return store_pget(&schema.structs, idx);
     }
     return NULL;
 }
 
+size_t vis_struct_num()
+{
+    return schema.structs.size;
+}
+
+vis_struct_t * vis_get_struct(size_t idx)
+{
+    return store_pget(&schema.structs, idx);
+}
+
 // Add a new field to a visual structure
 vis_field_t * vis_add_field(vis_struct_t *st, const char *name, size_t size, vis_field_type_t type, const char *description)
 {
     vis_field_t * field = store_alloc(&st->fields);
-    strncpy_s(field->name, MAX_NAME_LEN + 1, name, MAX_NAME_LEN);
+    field->index = st->fields.size - 1;
+    field->offset = st->size;
     field->size = size;
     field->type = type;
-    strncpy_s(field->description, MAX_DESCR_LEN + 1, description, MAX_DESCR_LEN);
-    //field->value undefined
+    field->name = str_intern(&schema.strings, name, strlen(name));
+    field->description = str_intern(&schema.strings, description, strlen(description));
+    field->value_name = NULL;
+    field->flag_names = NULL;
+    st->size += size;
+    name_index_add(&st->field_index, name, field->name.len, field->index);
     store_create(&field->valid_values, vis_value_info_t);
+    store_create(&field->value_order, uint32_t);
+    store_create(&field->flag_first, uint32_t);
     return field;
 }
 
 // Find a field of a visual structure
-vis_field_t * vis_find_field(vis_struct_t *st, const char *field_name)
+vis_field_t * vis_find_field(const vis_struct_t *st, const char *field_name)
 {
-    for (size_t i = 0; i < st->fields.size; i++) {
-        vis_field_t *f = store_pget(&st->fields, i);
-        if (strcmp(f->name, field_name) == 0) {
-            return f;
+    size_t idx;
+    if (name_index_find(&st->field_index, field_name, strlen(field_name), _field_name, st, &idx)) {
+        return store_pget(&st->fields, idx);
+    }
+    return NULL;
+}
+
+// Find the first valid value of an enum field equal to value, by binary search
+const vis_value_info_t * vis_find_value_info(const vis_field_t *field, vis_value_t value)
+{
+    const uint32_t *order = field->value_order.data;
+    size_t lo = 0;
+    size_t hi = field->value_order.size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        const vis_value_info_t *vi = store_pget(&field->valid_values, order[mid]);
+        if (vi->value < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < field->value_order.size) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, order[lo]);
+        if (vi->value == value) {
+            return vi;
         }
     }
     return NULL;
 }
 
-// Get field value as a string
-const char * vis_field_value_str(vis_field_t *field)
+// Append string to buffer, truncating it if needed. Returns new position.
+static size_t _append(char *buffer, size_t size, size_t pos, const char *str, size_t len)
 {
-    static char buffer[MAX_VALUE_STR_LEN + 1];
+    if (pos + len + 1 > size) {
+        len = (pos + 1 < size) ? size - pos - 1 : 0;
+    }
+    memcpy(buffer + pos, str, len);
+    buffer[pos + len] = '\0';
+    return pos + len;
+}
+
+// Append NUL-terminated string to buffer, truncating it if needed. Returns new position.
+size_t vis_append_str(char *buffer, size_t size, size_t pos, const char *str)
+{
+    return _append(buffer, size, pos, str, strlen(str));
+}
+
+static size_t _append_value_name(char *buffer, size_t size, size_t pos, const vis_value_info_t *vi)
+{
+    pos = _append(buffer, size, pos, vis_str(vi->name), vi->name.len);
+    return _append(buffer, size, pos, " ", 1);
+}
+
+// Format field value as a string into buffer of given size. Returns buffer.
+const char * vis_field_value_str(const vis_field_t *field, vis_value_t value, char *buffer, size_t size)
+{
+    buffer[0] = '\0';
 
     switch (field->type)
     {
         case VIS_UINT:
         {
-            sprintf_s(buffer, MAX_VALUE_STR_LEN + 1, "%lld", field->value);
+            sprintf_s(buffer, size, "%lld", value);
             break;
         }
 
         case VIS_ENUM:
         {
-            vis_value_info_t *matching_vi = NULL;
-            for (size_t i = 0; i < field->valid_values.size; i++) {
-                vis_value_info_t *vi = store_pget(&field->valid_values, i);
-                if (vi->value == field->value) {
-                    matching_vi = vi;
-                    break;
-                }
+            const char *name = NULL;
+            if (field->value_name) {
+                name = field->value_name(value);
+            } else {
+                const vis_value_info_t *vi = vis_find_value_info(field, value);
+                name = vi ? vis_str(vi->name) : NULL;
             }
-
-            if (matching_vi) {
-                sprintf_s(buffer, MAX_VALUE_STR_LEN + 1, "%s", matching_vi->name);
+            if (name) {
+                _append(buffer, size, 0, name, strlen(name));
             } else {
-                sprintf_s(buffer, MAX_VALUE_STR_LEN + 1, "Unknown (0x%llx)", field->value);
+                sprintf_s(buffer, size, "Unknown (0x%llx)", value);
             }
-
             break;
         }
 
         case VIS_FLAG:
         {
+            if (field->flag_names) {
+                field->flag_names(value, buffer, size);
+                break;
+            }
+            if (field->flag_first.size == 0) {
+                break;
+            }
+
+            const uint32_t *order = field->value_order.data;
+            const uint32_t *first = field->flag_first.data;
             size_t pos = 0;
-            for (size_t i = 0; i < field->valid_values.size; i++) {
-                vis_value_info_t *vi = store_pget(&field->valid_values, i);
-                if (field->value & vi->value) {
-                    pos += sprintf_s(buffer + pos, MAX_VALUE_STR_LEN + 1 - pos, "%s ", vi->name);
+
+            // Single-bit values: visit only the bits that are set
+            for (vis_value_t bits = value; bits; bits &= bits - 1) {
+                unsigned int bit = bit_index(bits);
+                for (uint32_t k = first[bit]; k < first[bit + 1]; k++) {
+                    pos = _append_value_name(buffer, size, pos, store_pget(&field->valid_values, order[k]));
+                }
+            }
+
+            // Values of several bits match if any of their bits is set
+            for (uint32_t k = first[VIS_FLAG_BUCKETS - 1]; k < first[VIS_FLAG_BUCKETS]; k++) {
+                const vis_value_info_t *vi = store_pget(&field->valid_values, order[k]);
+                if (value & vi->value) {
+                    pos = _append_value_name(buffer, size, pos, vi);
                 }
             }
             break;
@@ -104,7 +209,20 @@ const char * vis_field_value_str(vis_field_t *field)
 
         case VIS_TIME:
         {
-            sprintf_s(buffer, MAX_VALUE_STR_LEN + 1, "%s", ctime((time_t *)&field->value));
+            time_t time = (time_t)value;
+            ctime_s(buffer, size, &time);
+            break;
+        }
+
+        case VIS_CHAR:
+        {
+            // Bytes of the value in image order, up to the first NUL
+            size_t len = 0;
+            while (len < sizeof(value) && len + 1 < size && (value >> (8 * len)) & 0xff) {
+                buffer[len] = (char)((value >> (8 * len)) & 0xff);
+                len++;
+            }
+            buffer[len] = '\0';
             break;
         }
     }
@@ -112,35 +230,101 @@ const char * vis_field_value_str(vis_field_t *field)
     return buffer;
 }
 
+// Bucket of a flag value: its bit index, or the last bucket if it is not a single bit
+static size_t _flag_bucket(vis_value_t value)
+{
+    if (value != 0 && (value & (value - 1)) == 0) {
+        return bit_index(value);
+    }
+    return VIS_FLAG_BUCKETS - 1;
+}
+
+// Rebuild flag lookup: value_order groups valid values by bucket, in order of
+// addition, and flag_first holds the start of every bucket
+static void _index_flags(vis_field_t *field)
+{
+    uint32_t count[VIS_FLAG_BUCKETS] = { 0 };
+    for (size_t i = 0; i < field->valid_values.size; i++) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, i);
+        count[_flag_bucket(vi->value)]++;
+    }
+
+    field->flag_first.size = 0;
+    uint32_t *first = store_alloc_n(&field->flag_first, VIS_FLAG_BUCKETS + 1);
+    first[0] = 0;
+    for (size_t b = 0; b < VIS_FLAG_BUCKETS; b++) {
+        first[b + 1] = first[b] + count[b];
+    }
+
+    field->value_order.size = 0;
+    uint32_t *order = store_alloc_n(&field->value_order, field->valid_values.size);
+    uint32_t next[VIS_FLAG_BUCKETS];
+    memcpy(next, first, sizeof(next));
+    for (size_t i = 0; i < field->valid_values.size; i++) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, i);
+        order[next[_flag_bucket(vi->value)]++] = (uint32_t)i;
+    }
+}
+
+// Insert the last valid value into value_order, after all equal values
+static void _index_enum_value(vis_field_t *field)
+{
+    uint32_t idx = (uint32_t)(field->valid_values.size - 1);
+    const vis_value_info_t *new_vi = store_pget(&field->valid_values, idx);
+
+    store_alloc(&field->value_order);
+    uint32_t *order = field->value_order.data;
+    size_t pos = field->value_order.size - 1;
+    while (pos > 0) {
+        const vis_value_info_t *vi = store_pget(&field->valid_values, order[pos - 1]);
+        if (vi->value <= new_vi->value) {
+            break;
+        }
+        order[pos] = order[pos - 1];
+        pos--;
+    }
+    order[pos] = idx;
+}
+
 // Add a new valid value to a field of a visual structure
 void vis_add_value_info(vis_field_t *field, const char *name, vis_value_t value, const char *description)
 {
     vis_value_info_t *vi = store_alloc(&field->valid_values);
-    strncpy_s(vi->name, MAX_NAME_LEN + 1, name, MAX_NAME_LEN);
     vi->value = value;
-    strncpy_s(vi->description, MAX_DESCR_LEN + 1, description, MAX_DESCR_LEN);
+    vi->name = str_intern(&schema.strings, name, strlen(name));
+    vi->description = str_intern(&schema.strings, description, strlen(description));
+
+    if (field->type == VIS_FLAG) {
+        _index_flags(field);
+    } else {
+        _index_enum_value(field);
+    }
 }
 
-// Read a value from file
-vis_value_t vis_read_value(FILE *infile, size_t size)
+// Read a value from image
+vis_value_t vis_read_value(const pe_image_t *image, size_t offset, size_t size)
 {
     vis_value_t value = 0;
     if (size == 1) {
         uint8_t v;
-        fread(&v, 1, 1, infile);
-        value = v;
+        if (image_read_u8(image, offset, &v)) {
+            value = v;
+        }
     } else if (size == 2) {
         uint16_t v;
-        fread(&v, 2, 1, infile);
-        value = v;
+        if (image_read_u16(image, offset, &v)) {
+            value = v;
+        }
     } else if (size == 4) {
         uint32_t v;
-        fread(&v, 4, 1, infile);
-        value = v;
+        if (image_read_u32(image, offset, &v)) {
+            value = v;
+        }
     } else if (size == 8) {
         uint64_t v;
-        fread(&v, 8, 1, infile);
-        value = v;
+        if (image_read_u64(image, offset, &v)) {
+            value = v;
+        }
     }
     return value;
 }
@@ -156,38 +340,94 @@ const char * vis_field_type_to_str(vis_field_type_t type)
         case VIS_ENUM: return "ENUM";
         case VIS_FLAG: return "FLAG";
         case VIS_TIME: return "TIME";
+        case VIS_CHAR: return "CHAR";
     }
     return "Unknown";
 }
 
+vis_field_type_t vis_field_type_from_str(const char *str)
+{
+    for (vis_field_type_t type = VIS_UINT; type < VIS_INVALID; type++) {
+        if (strcmp(str, vis_field_type_to_str(type)) == 0) {
+            return type;
+        }
+    }
+    return VIS_INVALID;
+}
+
 // Print all known structures to stdout
 void vis_print_all()
 {
-    for (size_t i = 0; i < structs.size; i++) {
-        vis_struct_t *st = store_pget(&structs, i);
-        printf("STRUCTURE: %s\n", st->name);
+    for (size_t i = 0; i < schema.structs.size; i++) {
+        vis_struct_t *st = store_pget(&schema.structs, i);
+        printf("STRUCTURE: %s\n", vis_str(st->name));
 
         for (size_t j = 0; j < st->fields.size; j++) {
             vis_field_t *f = store_pget(&st->fields, j);
-            printf("    Field: %s (%s, %lld bytes) = %s\n", f->name, vis_field_type_to_str(f->type), f->size, vis_field_value_str(f));
-            printf("           %s\n", f->description);
+            printf("    Field: %s (%s, %lld bytes)\n", vis_str(f->name), vis_field_type_to_str(f->type), f->size);
+            printf("           %s\n", vis_str(f->description));
 
             for (size_t k = 0; k < f->valid_values.size; k++) {
                 vis_value_info_t *vi = store_pget(&f->valid_values, k);
-                printf("        %-40s 0x%04llx %s\n", vi->name, vi->value, vi->description);
+                printf("        %-40s 0x%04llx %s\n", vis_str(vi->name), vi->value, vis_str(vi->description));
             }
         }
     }
 }
 
-// Read a structure from current position in a file
-void vis_read_struct(FILE *infile, const char *struct_name)
+// Allocate value storage of an instance of a structure
+void vis_instance_init(vis_instance_t *inst, const vis_struct_t *st)
 {
-    vis_struct_t *st = vis_find_struct(struct_name);
+    inst->st = st;
+    inst->offset = 0;
+    inst->values = calloc(st->fields.size ? st->fields.size : 1, sizeof(vis_value_t));
+}
+
+// Release value storage of an instance
+void vis_instance_free(vis_instance_t *inst)
+{
+    free(inst->values);
+    inst->values = NULL;
+}
+
+// Get decoded value of a field
+vis_value_t vis_instance_value(const vis_instance_t *inst, const vis_field_t *field)
+{
+    assert(field->index < inst->st->fields.size);
+    return inst->values[field->index];
+}
+
+// Read a structure at given offset in image into an instance. The instance may
+// be reused for many reads. Returns the structure size.
+size_t vis_read_struct(const pe_image_t *image, size_t offset, vis_instance_t *inst)
+{
+    const vis_struct_t *st = inst->st;
     assert(st);
-    
+
+    inst->offset = offset;
+
+    // Generated decoders need the whole structure in range
+    const uint8_t *data = image_ptr(image, offset, st->size);
+    if (st->decode && data) {
+        st->decode(data, inst->values);
+        return st->size;
+    }
+
     for (size_t i = 0; i < st->fields.size; i++) {
-        vis_field_t *field = store_pget(&st->fields, i);
-        field->value = vis_read_value(infile, field->size);
+        const vis_field_t *field = store_pget(&st->fields, i);
+        inst->values[i] = vis_read_value(image, offset + field->offset, field->size);
     }
-}
\ No newline at end of file
+    return st->size;
+}
+
+// Print decoded values of an instance to stdout
+void vis_print_instance(const vis_instance_t *inst)
+{
+    const vis_struct_t *st = inst->st;
+    char buffer[MAX_VALUE_STR_LEN + 1];
+    printf("%s at 0x%llx:\n", vis_str(st->name), (unsigned long long)inst->offset);
+    for (size_t i = 0; i < st->fields.size; i++) {
+        const vis_field_t *f = store_pget(&st->fields, i);
+        printf("    %-30s %s\n", vis_str(f->name), vis_field_value_str(f, inst->values[i], buffer, sizeof(buffer)));
+    }
+}
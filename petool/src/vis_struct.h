@@ -10,23 +10,48 @@
 #include <stdint.h>
 #include <stdio.h>
 #include "store.h"
+#include "image.h"
+#include "name_index.h"
+#include "str_arena.h"
 
 #define MAX_NAME_LEN 100
 #define MAX_DESCR_LEN 5000
+#define MAX_VALUE_STR_LEN 5000
+
+// Flag lookup buckets: one per bit, plus one for values that are not a single bit
+#define VIS_FLAG_BUCKETS 65
 
 typedef uint64_t vis_value_t;
 
+const char * vis_str(str_ref_t ref);
+
+// Generated decoder of a whole structure from data known to be in range:
+// stores one value per field, in field order
+typedef void (*vis_decode_fn_t)(const uint8_t *data, vis_value_t *values);
+
+// Generated name lookup of a valid value, NULL if the value is unknown
+typedef const char * (*vis_value_name_fn_t)(vis_value_t value);
+
+// Generated FLAG decomposition: writes the names of the flags set in value,
+// each followed by a space, and returns the string length
+typedef size_t (*vis_flag_names_fn_t)(vis_value_t value, char *buffer, size_t size);
+
 /**
  * Structure with fields for visual representation
  */
 typedef struct vis_struct_t
 {
-    char    name[MAX_NAME_LEN + 1];
-    store_t fields;
+    str_ref_t       name;
+    size_t          size;
+    store_t         fields;
+    name_index_t    field_index;
+    vis_decode_fn_t decode;         // NULL if no generated decoder is registered
 } vis_struct_t;
 
 vis_struct_t * vis_create_struct(const char *name);
 vis_struct_t * vis_find_struct(const char *name);
+size_t vis_struct_num();
+vis_struct_t * vis_get_struct(size_t idx);
 
 typedef enum
 {
@@ -34,25 +59,35 @@ typedef enum
     VIS_ENUM,
     VIS_FLAG,
     VIS_TIME,
+    VIS_CHAR,
 
     VIS_INVALID,
 } vis_field_type_t;
 
+vis_field_type_t vis_field_type_from_str(const char *str);
+const char * vis_field_type_to_str(vis_field_type_t type);
+
 /**
- * A field in visual structure
+ * A field in visual structure. Fields are part of the schema and are not
+ * changed by decoding; decoded values are kept in vis_instance_t.
  */
 typedef struct vis_field_t
 {
-    char             name[MAX_NAME_LEN + 1];
-    size_t           size;
-    vis_field_type_t type;
-    char             description[MAX_DESCR_LEN + 1];
-    vis_value_t      value;
-    store_t          valid_values;
+    size_t              index;          // index of field in structure
+    size_t              offset;         // offset of field from structure start
+    size_t              size;
+    vis_field_type_t    type;
+    store_t             valid_values;
+    store_t             value_order;    // uint32_t indices of valid_values: by value (ENUM) or by bit (FLAG)
+    store_t             flag_first;     // FLAG: VIS_FLAG_BUCKETS + 1 offsets of each bit's run in value_order
+    str_ref_t           name;
+    str_ref_t           description;
+    vis_value_name_fn_t value_name;     // generated ENUM lookup, NULL if not registered
+    vis_flag_names_fn_t flag_names;     // generated FLAG decomposition, NULL if not registered
 } vis_field_t;
 
 vis_field_t * vis_add_field(vis_struct_t *st, const char *name, size_t size, vis_field_type_t type, const char *description);
-vis_field_t * vis_find_field(vis_struct_t *st, const char *field_name);
+vis_field_t * vis_find_field(const vis_struct_t *st, const char *field_name);
 
 
 /**
@@ -60,16 +95,50 @@ vis_field_t * vis_find_field(vis_struct_t *st, const char *field_name);
  */
 typedef struct vis_value_info_t
 {
-    char name[MAX_NAME_LEN + 1];
     vis_value_t value;
-    char description[MAX_DESCR_LEN + 1];
+    str_ref_t   name;
+    str_ref_t   description;
 } vis_value_info_t;
 
 void vis_add_value_info(vis_field_t *field, const char *name, vis_value_t value, const char *description);
-const char * vis_field_value_str(vis_field_t *field);
+const vis_value_info_t * vis_find_value_info(const vis_field_t *field, vis_value_t value);
+size_t vis_append_str(char *buffer, size_t size, size_t pos, const char *str);
+const char * vis_field_value_str(const vis_field_t *field, vis_value_t value, char *buffer, size_t size);
 
 void vis_print_all();
 
-void vis_read_struct(FILE *infile, const char *struct_name);
+
+/**
+ * The schema: all visual structures and the strings they refer to. A schema
+ * loaded from a schema cache refers to read-only memory; tables that are
+ * extended later are copied to the heap first.
+ */
+typedef struct vis_schema_t
+{
+    store_t      structs;
+    name_index_t struct_index;
+    str_arena_t  strings;
+} vis_schema_t;
+
+vis_schema_t * vis_schema();
+
+
+/**
+ * Values of a visual structure decoded from one image. Many instances, in any
+ * number of threads, may share one structure.
+ */
+typedef struct vis_instance_t
+{
+    const vis_struct_t *st;
+    size_t              offset;     // offset of decoded structure in image
+    vis_value_t        *values;     // one value per field, in field order
+} vis_instance_t;
+
+void vis_instance_init(vis_instance_t *inst, const vis_struct_t *st);
+void vis_instance_free(vis_instance_t *inst);
+vis_value_t vis_instance_value(const vis_instance_t *inst, const vis_field_t *field);
+
+size_t vis_read_struct(const pe_image_t *image, size_t offset, vis_instance_t *inst);
+void vis_print_instance(const vis_instance_t *inst);
 
 #endif